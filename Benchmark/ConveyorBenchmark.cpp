@@ -1,6 +1,20 @@
+#include <array>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
 #include <benchmark/benchmark.h>
 
 #include <concurrency/conveyor.h>
+#include <concurrency/batch_conveyor.h>
+#include <concurrency/ordered_conveyor.h>
+#include <concurrency/sharded_conveyor.h>
+#include <concurrency/coalescing_conveyor.h>
+#include <concurrency/priority_conveyor.h>
+#include <concurrency/thread_pool.h>
 
 static void conveyor_class_move(benchmark::State& state)
 {
@@ -21,6 +35,87 @@ static void conveyor_class_move(benchmark::State& state)
 BENCHMARK(conveyor_class_move)->RangeMultiplier(2)->Range(8, 8<<4);
 
 
+static void conveyor_class_move_thread_pool(benchmark::State& state)
+{
+    auto&& results = std::vector<std::string>();
+
+    auto&& stringValue = std::string(100, 'a');
+
+    auto&& pool = jstd::thread_pool(1);
+    auto&& options = jstd::conveyor_options();
+    options.executor = &pool;
+
+    for (auto _ : state)
+    {
+        auto&& testConveyor =
+                jstd::conveyor<std::string>( [&](auto&& value) { results.push_back(std::move(value)); }, options);
+
+        for (auto j = 0; j < state.range(0); ++j)
+            testConveyor.push(stringValue + std::to_string(j));
+    }
+}
+
+BENCHMARK(conveyor_class_move_thread_pool)->RangeMultiplier(2)->Range(8, 8<<4);
+
+
+// Same epochs as conveyor_class_move, but the conveyor is kept alive and flushed after each epoch.
+static void conveyor_class_move_flush(benchmark::State& state)
+{
+    auto&& results = std::vector<std::string>();
+
+    auto&& stringValue = std::string(100, 'a');
+
+    using ConveyorType = jstd::conveyor<std::string,
+                                        jstd::blocking_queue<std::string>,
+                                        std::function<void(std::string&&)>,
+                                        jstd::no_statistics,
+                                        jstd::conveyor_flush>;
+
+    auto&& testConveyor = ConveyorType( [&](auto&& value) { results.push_back(std::move(value)); });
+
+    for (auto _ : state)
+    {
+        for (auto j = 0; j < state.range(0); ++j)
+            testConveyor.push(stringValue + std::to_string(j));
+
+        testConveyor.flush();
+    }
+}
+
+BENCHMARK(conveyor_class_move_flush)->RangeMultiplier(2)->Range(8, 8<<4);
+
+
+// The argument enables the recycling of the pushed strings, so that the producer reuses the buffers the processor
+// thread has released instead of allocating new ones.
+static void conveyor_class_string_recycling(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    auto&& options = jstd::conveyor_options();
+    options.recycle_capacity = state.range(0) != 0 ? 1024 : 0;
+
+    {
+        auto&& testConveyor = jstd::conveyor<std::string>([&](std::string&& value) { processed += value.size(); },
+                                                          options);
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < 64; ++j)
+            {
+                auto&& value = testConveyor.acquire();
+                value.assign(100, 'a');
+
+                testConveyor.push(std::move(value));
+            }
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed / 100));
+}
+
+BENCHMARK(conveyor_class_string_recycling)->Arg(0)->Arg(1)->UseRealTime();
+
+
 static void conveyor_class_copy(benchmark::State& state)
 {
     auto&& results = std::vector<std::string>();
@@ -40,3 +135,530 @@ static void conveyor_class_copy(benchmark::State& state)
 }
 
 BENCHMARK(conveyor_class_copy)->RangeMultiplier(2)->Range(8, 8<<4);
+
+
+template <typename Queue>
+static void conveyor_class_throughput(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::conveyor<std::size_t, Queue>([&](std::size_t&& value) { processed += value; });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor.push(std::size_t(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK_TEMPLATE(conveyor_class_throughput, jstd::blocking_queue<std::size_t>)
+->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_class_throughput, jstd::spsc_queue<std::size_t>)
+->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+// Value that is as expensive to move as to copy.
+struct heavy_value
+{
+    explicit heavy_value(std::size_t value)
+    {
+        data.fill(static_cast<char>(value));
+    }
+
+    std::array<char, 512> data;
+};
+
+static void conveyor_class_push_heavy(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::make_conveyor<heavy_value, jstd::spsc_queue<heavy_value> >(
+                [&](heavy_value&& value) { processed += value.data[0] != 0; });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor->push(heavy_value(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK(conveyor_class_push_heavy)->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+static void conveyor_class_emplace_heavy(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::make_conveyor<heavy_value, jstd::spsc_queue<heavy_value> >(
+                [&](heavy_value&& value) { processed += value.data[0] != 0; });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor->emplace(std::size_t(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK(conveyor_class_emplace_heavy)->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+static void conveyor_class_throughput_statistics(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::make_conveyor<std::size_t,
+                                                  jstd::spsc_queue<std::size_t>,
+                                                  jstd::conveyor_statistics>(
+                [&](std::size_t&& value) { processed += value; });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor->push(std::size_t(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK(conveyor_class_throughput_statistics)->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+
+// Round trip of a single value through an idle conveyor, which is dominated by waking up the processor.
+template <typename Queue>
+static void conveyor_class_latency(benchmark::State& state)
+{
+    auto&& processed = std::atomic<std::size_t>(0);
+
+    auto&& testConveyor = jstd::conveyor<std::size_t, Queue>(
+            [&](std::size_t&& value) { processed.store(value, std::memory_order_release); });
+
+    auto&& sent = std::size_t(0);
+
+    for (auto _ : state)
+    {
+        testConveyor.push(++sent);
+
+        while (processed.load(std::memory_order_acquire) != sent)
+            std::this_thread::yield();
+
+        // Give the processor time to fall back into its wait strategy.
+        for (auto i = 0; i < 256; ++i)
+            benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_TEMPLATE(conveyor_class_latency, jstd::spsc_queue<std::size_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(conveyor_class_latency, jstd::spsc_queue<std::size_t, jstd::spin_wait<> >)->UseRealTime();
+BENCHMARK_TEMPLATE(conveyor_class_latency, jstd::spsc_queue<std::size_t, jstd::busy_wait>)->UseRealTime();
+
+
+static void batch_conveyor_throughput(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::batch_conveyor<std::size_t>([&](std::vector<std::size_t>&& batch)
+                                                                {
+                                                                    for (const auto value : batch)
+                                                                        processed += value;
+                                                                });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor.push(std::size_t(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK(batch_conveyor_throughput)->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+// Arguments are the batch size and the batch delay in microseconds. The processor calls per value show how well
+// the options collect the values into batches.
+static void batch_conveyor_micro_batching(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+    auto&& batches = std::size_t(0);
+
+    auto&& options = jstd::conveyor_options();
+    options.batch_size = static_cast<std::size_t>(state.range(0));
+    options.batch_delay = std::chrono::microseconds(state.range(1));
+
+    {
+        auto&& testConveyor = jstd::batch_conveyor<std::size_t>([&](std::vector<std::size_t>&& batch)
+                                                                {
+                                                                    ++batches;
+
+                                                                    for (const auto value : batch)
+                                                                        processed += value;
+                                                                },
+                                                                options);
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < 64; ++j)
+                testConveyor.push(std::size_t(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+    state.counters["batches"] = static_cast<double>(batches);
+}
+
+static void batch_options(benchmark::internal::Benchmark* benchmark)
+{
+    for (const auto delay : { 0, 100 })
+    {
+        for (const auto size : { 0, 16, 64 })
+            benchmark->Args({ size, delay });
+    }
+}
+
+BENCHMARK(batch_conveyor_micro_batching)->Apply(batch_options)->UseRealTime();
+
+
+template <typename Queue>
+static void conveyor_class_producers(benchmark::State& state)
+{
+    const auto producerCount = state.range(0);
+    const auto valueCount = 1 << 16;
+
+    auto&& processed = std::size_t(0);
+
+    for (auto _ : state)
+    {
+        auto&& testConveyor = jstd::conveyor<std::size_t, Queue>([&](std::size_t&& value) { processed += value; });
+        auto&& producers = std::vector<std::thread>();
+
+        for (auto i = 0; i < producerCount; ++i)
+            producers.emplace_back([&]
+                                   {
+                                       for (auto j = 0; j < valueCount; ++j)
+                                           testConveyor.push(std::size_t(1));
+                                   });
+
+        for (auto& producer : producers)
+            producer.join();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+static void producer_counts(benchmark::internal::Benchmark* benchmark)
+{
+    const auto maxProducers = std::max(1u, std::thread::hardware_concurrency());
+
+    for (auto producers = 1u; producers < maxProducers; producers *= 2)
+        benchmark->Arg(producers);
+
+    benchmark->Arg(maxProducers);
+}
+
+BENCHMARK_TEMPLATE(conveyor_class_producers, jstd::blocking_queue<std::size_t>)
+->Apply(producer_counts)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_class_producers, jstd::mpsc_queue<std::size_t>)
+->Apply(producer_counts)->UseRealTime();
+
+
+template <typename Queue>
+static void conveyor_class_threads(benchmark::State& state)
+{
+    auto&& options = jstd::conveyor_options();
+    options.threads = static_cast<std::size_t>(state.range(0));
+
+    auto&& processed = std::atomic<std::size_t>(0);
+
+    for (auto _ : state)
+    {
+        auto&& testConveyor = jstd::conveyor<std::size_t, Queue>([&](std::size_t&& value)
+                                                                 {
+                                                                     auto hash = value;
+
+                                                                     for (auto i = 0; i < 1000; ++i)
+                                                                     {
+                                                                         hash = hash * 31 + i;
+                                                                         benchmark::DoNotOptimize(hash);
+                                                                     }
+
+                                                                     ++processed;
+                                                                 },
+                                                                 options);
+
+        for (auto j = 0; j < 1 << 12; ++j)
+            testConveyor.push(std::size_t(j));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed.load()));
+}
+
+BENCHMARK_TEMPLATE(conveyor_class_threads, jstd::blocking_queue<std::size_t>)
+->Apply(producer_counts)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_class_threads, jstd::mpmc_queue<std::size_t>)
+->Apply(producer_counts)->UseRealTime();
+
+
+template <typename Queue>
+static void ordered_conveyor_threads(benchmark::State& state)
+{
+    auto&& options = jstd::conveyor_options();
+    options.threads = static_cast<std::size_t>(state.range(0));
+
+    auto&& processed = std::size_t(0);
+
+    for (auto _ : state)
+    {
+        auto&& testConveyor = jstd::ordered_conveyor<std::size_t, std::size_t, Queue>(
+                [](std::size_t&& value)
+                {
+                    auto hash = value;
+
+                    for (auto i = 0; i < 1000; ++i)
+                    {
+                        hash = hash * 31 + i;
+                        benchmark::DoNotOptimize(hash);
+                    }
+
+                    return hash;
+                },
+                [&](std::size_t&&) { ++processed; },
+                options);
+
+        for (auto j = 0; j < 1 << 12; ++j)
+            testConveyor.push(std::size_t(j));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK_TEMPLATE(ordered_conveyor_threads, jstd::blocking_queue<std::size_t>)
+->Apply(producer_counts)->UseRealTime();
+
+BENCHMARK_TEMPLATE(ordered_conveyor_threads, jstd::mpmc_queue<std::size_t>)
+->Apply(producer_counts)->UseRealTime();
+
+
+static void sharded_conveyor_lanes(benchmark::State& state)
+{
+    auto&& options = jstd::conveyor_options();
+    options.threads = static_cast<std::size_t>(state.range(0));
+
+    auto&& processed = std::atomic<std::size_t>(0);
+
+    for (auto _ : state)
+    {
+        auto&& testConveyor = jstd::sharded_conveyor<std::size_t, std::size_t>(
+                [](const std::size_t& value) { return value % 64; },
+                [&](std::size_t&& value)
+                {
+                    auto hash = value;
+
+                    for (auto i = 0; i < 1000; ++i)
+                    {
+                        hash = hash * 31 + i;
+                        benchmark::DoNotOptimize(hash);
+                    }
+
+                    ++processed;
+                },
+                options);
+
+        for (auto j = 0; j < 1 << 12; ++j)
+            testConveyor.push(std::size_t(j));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed.load()));
+}
+
+BENCHMARK(sharded_conveyor_lanes)->Apply(producer_counts)->UseRealTime();
+
+
+// Updates for a small set of keys, of which only the latest value per key needs to be processed.
+static void coalescing_conveyor_updates(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::coalescing_conveyor<std::pair<std::size_t, std::size_t>, std::size_t>(
+                [](const std::pair<std::size_t, std::size_t>& update) { return update.first; },
+                [&](std::pair<std::size_t, std::size_t>&& update)
+                {
+                    auto hash = update.second;
+
+                    for (auto i = 0; i < 100; ++i)
+                    {
+                        hash = hash * 31 + i;
+                        benchmark::DoNotOptimize(hash);
+                    }
+
+                    ++processed;
+                });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor.push(std::make_pair(std::size_t(j % 64), std::size_t(j)));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["processed"] = static_cast<double>(processed);
+}
+
+BENCHMARK(coalescing_conveyor_updates)->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+
+template <typename Storage>
+static void priority_conveyor_throughput(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::priority_conveyor<std::size_t, Storage>(
+                [&](std::size_t&& value) { processed += value; });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor.push(static_cast<std::size_t>(j % 4), std::size_t(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK_TEMPLATE(priority_conveyor_throughput, jstd::priority_lanes<4>)
+->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+BENCHMARK_TEMPLATE(priority_conveyor_throughput, jstd::priority_heap<4>)
+->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+
+static void conveyor_class_throughput_processor_type(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    {
+        auto&& testConveyor = jstd::make_conveyor<std::size_t, jstd::spsc_queue<std::size_t> >(
+                [&](std::size_t&& value) { processed += value; });
+
+        for (auto _ : state)
+        {
+            for (auto j = 0; j < state.range(0); ++j)
+                testConveyor->push(std::size_t(1));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK(conveyor_class_throughput_processor_type)->RangeMultiplier(8)->Range(8, 8<<6)->UseRealTime();
+
+
+#ifdef __linux__
+
+static int cpu_topology(unsigned cpu, const char* name)
+{
+    auto&& file = std::ifstream("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+    auto value = -1;
+
+    file >> value;
+
+    return value;
+}
+
+static int cpu_node(unsigned cpu)
+{
+    for (auto node = 0; node < 256; ++node)
+    {
+        const auto path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/node" + std::to_string(node);
+
+        if (access(path.c_str(), F_OK) == 0)
+            return node;
+    }
+
+    return -1;
+}
+
+// Arguments are the CPUs of the producer and the processor: the other hardware thread of the same core, another
+// core of the same socket and a core of another socket. Placements that the machine does not have are skipped.
+static void placements(benchmark::internal::Benchmark* benchmark)
+{
+    const auto core = cpu_topology(0, "core_id");
+    const auto socket = cpu_topology(0, "physical_package_id");
+
+    auto&& found = std::array<int, 3>{ { -1, -1, -1 } };
+
+    for (auto cpu = 1u; cpu < std::thread::hardware_concurrency(); ++cpu)
+    {
+        const auto sameSocket = cpu_topology(cpu, "physical_package_id") == socket;
+        const auto sameCore = sameSocket && cpu_topology(cpu, "core_id") == core;
+        auto& placement = found[sameCore ? 0 : sameSocket ? 1 : 2];
+
+        if (placement < 0)
+            placement = static_cast<int>(cpu);
+    }
+
+    benchmark->ArgNames({ "producer", "processor" });
+
+    for (const auto cpu : found)
+    {
+        if (cpu >= 0)
+            benchmark->Args({ 0, cpu });
+    }
+}
+
+static void conveyor_class_placement(benchmark::State& state)
+{
+    auto&& processed = std::size_t(0);
+
+    const auto processorCpu = static_cast<unsigned>(state.range(1));
+
+    // The ring is allocated on the node of the processor, which reads every value.
+    auto&& processorOptions = jstd::conveyor_options();
+    processorOptions.cpus = { processorCpu };
+    processorOptions.numa_node = cpu_node(processorCpu);
+
+    // The values are pushed by a conveyor of their own, so that the producer is placed by its options as well.
+    // Its small capacity keeps the benchmark loop in step with the producer.
+    auto&& producerOptions = jstd::conveyor_options();
+    producerOptions.cpus = { static_cast<unsigned>(state.range(0)) };
+    producerOptions.capacity = 1;
+
+    {
+        auto&& testConveyor = jstd::conveyor<std::size_t, jstd::spsc_queue<std::size_t> >(
+                [&](std::size_t&& value) { processed += value; }, processorOptions);
+
+        auto&& producer = jstd::conveyor<int, jstd::spsc_queue<int> >(
+                [&](int&& count)
+                {
+                    for (auto j = 0; j < count; ++j)
+                        testConveyor.push(std::size_t(1));
+                },
+                producerOptions);
+
+        for (auto _ : state)
+            producer.push(512);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(processed));
+}
+
+BENCHMARK(conveyor_class_placement)->Apply(placements)->UseRealTime();
+
+#endif
@@ -1,9 +1,11 @@
 #include <chrono>
+#include <thread>
 using namespace std::chrono;
 
 #include <benchmark/benchmark.h>
 
 #include <concurrency/conveyor_function.h>
+#include <concurrency/pipeline.h>
 
 static void conveyor_function_move(benchmark::State& state)
 {
@@ -68,4 +70,152 @@ BENCHMARK_TEMPLATE(conveyor_function, false)
 ->RangeMultiplier(2)->Ranges({{1 << 3, 1 << 6}, {1, 1 << 6}})->UseRealTime();
 
 BENCHMARK_TEMPLATE(conveyor_function, true)
-->RangeMultiplier(2)->Ranges({{1 << 3, 1 << 6}, {1, 1 << 6}})->UseRealTime();
\ No newline at end of file
+->RangeMultiplier(2)->Ranges({{1 << 3, 1 << 6}, {1, 1 << 6}})->UseRealTime();
+
+static void conveyor_function_parallel_converter(benchmark::State& state)
+{
+    const auto wait = milliseconds(1);
+    const auto replicas = static_cast<std::size_t>(state.range(1));
+
+    for (auto _ : state)
+    {
+        jstd::conveyor_function([&](jstd::conveyor_forwarder<milliseconds>& f)
+                                {
+                                    for (auto j = 0; j < state.range(0); ++j)
+                                        f.push(milliseconds(wait));
+                                },
+                                jstd::parallel(replicas, [](milliseconds&& value,
+                                                            jstd::conveyor_forwarder<milliseconds>& f)
+                                {
+                                    std::this_thread::sleep_for(value);
+                                    f.push(std::move(value));
+                                }),
+                                [](milliseconds&&) {});
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(conveyor_function_parallel_converter)
+->RangeMultiplier(2)->Ranges({{1 << 3, 1 << 6}, {1, 1 << 3}})->UseRealTime();
+
+template <bool persistent>
+static void conveyor_function_small_runs(benchmark::State& state)
+{
+    auto sum = 0;
+
+    const auto producer = [&](jstd::conveyor_forwarder<int>& f)
+    {
+        for (auto j = 0; j < state.range(0); ++j)
+            f.push(int(j));
+    };
+    const auto increment = [](int&& value, jstd::conveyor_forwarder<int>& f) { f.push(value + 1); };
+    const auto twice = [](int&& value, jstd::conveyor_forwarder<int>& f) { f.push(value * 2); };
+    const auto negate = [](int&& value, jstd::conveyor_forwarder<int>& f) { f.push(-value); };
+    const auto consumer = [&](int&& value) { sum += value; };
+
+    auto&& stages = jstd::make_pipeline(increment, twice, negate, consumer);
+
+    for (auto _ : state)
+    {
+        if (persistent)
+            stages->run(producer);
+        else
+            jstd::conveyor_function(producer, increment, twice, negate, consumer);
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(conveyor_function_small_runs, false)->RangeMultiplier(4)->Range(1, 1 << 6)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_function_small_runs, true)->RangeMultiplier(4)->Range(1, 1 << 6)->UseRealTime();
+
+template <template <typename...> class Forwarder>
+static void conveyor_function_forwarder(benchmark::State& state)
+{
+    auto sum = 0;
+
+    for (auto _ : state)
+    {
+        jstd::conveyor_function([&](Forwarder<int>& f)
+                                {
+                                    for (auto j = 0; j < state.range(0); ++j)
+                                        f.push(int(j));
+                                },
+                                [](int&& value, Forwarder<int>& f) { f.push(value + 1); },
+                                [&](int&& value) { sum += value; });
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(conveyor_function_forwarder, jstd::conveyor_forwarder)->Range(1 << 10, 1 << 16)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_function_forwarder, jstd::static_forwarder)->Range(1 << 10, 1 << 16)->UseRealTime();
+
+// Fused callables, that take a conveyor_forwarder, push directly to the following one. Values of callables, that
+// take a static_forwarder, are buffered and passed on after each call.
+template <template <typename...> class Forwarder, bool fused>
+static void conveyor_function_fused(benchmark::State& state)
+{
+    auto sum = 0;
+
+    const auto producer = [&](jstd::static_forwarder<int>& f)
+    {
+        for (auto j = 0; j < state.range(0); ++j)
+            f.push(int(j));
+    };
+    const auto filter = [](int&& value, Forwarder<int>& f)
+    {
+        if (value % 2 == 0)
+            f.push(std::move(value));
+    };
+    const auto project = [](int&& value, Forwarder<int>& f) { f.push(value / 2); };
+    const auto consumer = [&](int&& value) { sum += value; };
+
+    for (auto _ : state)
+    {
+        if (fused)
+            jstd::conveyor_function(producer, jstd::fuse(filter, project, consumer));
+        else
+            jstd::conveyor_function(producer, filter, project, consumer);
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(conveyor_function_fused, jstd::conveyor_forwarder, false)->Range(1 << 10, 1 << 16)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_function_fused, jstd::conveyor_forwarder, true)->Range(1 << 10, 1 << 16)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_function_fused, jstd::static_forwarder, false)->Range(1 << 10, 1 << 16)->UseRealTime();
+
+BENCHMARK_TEMPLATE(conveyor_function_fused, jstd::static_forwarder, true)->Range(1 << 10, 1 << 16)->UseRealTime();
+
+static void conveyor_function_capacity(benchmark::State& state)
+{
+    auto&& options = jstd::conveyor_options();
+    options.capacity = static_cast<std::size_t>(state.range(1));
+
+    auto&& line = std::string(100, 'a');
+    auto size = std::size_t(0);
+
+    for (auto _ : state)
+    {
+        jstd::conveyor_function(options,
+                                [&](jstd::static_forwarder<std::string>& f)
+                                {
+                                    for (auto j = 0; j < state.range(0); ++j)
+                                        f.push(line);
+                                },
+                                [](std::string&& value, jstd::static_forwarder<std::string>& f)
+                                {
+                                    f.push(std::move(value));
+                                },
+                                [&](std::string&& value) { size += value.size(); });
+    }
+    benchmark::DoNotOptimize(size);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(conveyor_function_capacity)->Ranges({{1 << 12, 1 << 16}, {0, 1 << 8}})->UseRealTime();
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include <concurrency/conveyor.h>
+#include <concurrency/thread_pool.h>
+
+using jstd::internal::affinity_scope;
+using testing::ElementsAre;
+using testing::Each;
+
+#ifdef __linux__
+
+namespace
+{
+    std::vector<unsigned> allowedCpus()
+    {
+        auto&& cpus = std::vector<unsigned>();
+        auto set = cpu_set_t();
+
+        if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+        {
+            for (auto cpu = 0u; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+            }
+        }
+
+        return cpus;
+    }
+
+    TEST(UnitTest_affinity, pinsAndRestores)
+    {
+        const auto previous = allowedCpus();
+        const auto cpu = previous.back();
+
+        {
+            const affinity_scope pinned({ cpu });
+
+    EXPECT_TRUE(pinned.pinned());
+    EXPECT_THAT(allowedCpus(), ElementsAre(cpu));
+    EXPECT_EQ(static_cast<int>(cpu), sched_getcpu());
+        }
+
+    EXPECT_EQ(previous, allowedCpus());
+    }
+
+    TEST(UnitTest_affinity, emptySetDoesNotPin)
+    {
+        const auto previous = allowedCpus();
+
+        const affinity_scope pinned({});
+
+    EXPECT_FALSE(pinned.pinned());
+    EXPECT_EQ(previous, allowedCpus());
+    }
+
+    TEST(UnitTest_affinity, conveyorPinsProcessor)
+    {
+        const auto cpu = allowedCpus().back();
+        auto&& processorCpus = std::vector<int>();
+
+        auto&& options = jstd::conveyor_options();
+        options.cpus = { cpu };
+
+        {
+            auto&& testConveyor = jstd::conveyor<int>([&](int&&) { processorCpus.push_back(sched_getcpu()); },
+                                                      options);
+
+            for (auto i = 0; i < 10; ++i)
+                testConveyor.push(int(i));
+        }
+
+    ASSERT_EQ(10, processorCpus.size());
+    EXPECT_THAT(processorCpus, Each(static_cast<int>(cpu)));
+    }
+
+    TEST(UnitTest_affinity, executorThreadIsRestored)
+    {
+        const auto previous = allowedCpus();
+
+        auto&& pool = jstd::thread_pool(1);
+
+        auto&& options = jstd::conveyor_options();
+        options.cpus = { previous.front() };
+        options.executor = &pool;
+
+        {
+            auto&& testConveyor = jstd::conveyor<int>([](int&&) {}, options);
+            testConveyor.push(1);
+        }
+
+        auto&& poolCpus = std::promise<std::vector<unsigned> >();
+        pool.execute([&] { poolCpus.set_value(allowedCpus()); });
+
+    EXPECT_EQ(previous, poolCpus.get_future().get());
+    }
+
+    TEST(UnitTest_affinity, queueOnNumaNode)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 1 << 16;
+        options.numa_node = 0;
+
+        auto&& sum = 0;
+
+        {
+            // Whether the kernel accepts the node depends on the machine, the values must arrive in any case.
+            auto&& testConveyor = jstd::conveyor<int, jstd::spsc_queue<int> >([&](int&& value) { sum += value; },
+                                                                               options);
+
+            for (auto i = 1; i <= 1000; ++i)
+                testConveyor.push(int(i));
+        }
+
+    EXPECT_EQ(500500, sum);
+    }
+
+    TEST(UnitTest_affinity, mpmcQueueOnNumaNode)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.numa_node = 0;
+        options.threads = 2;
+
+        auto&& sum = std::atomic<int>(0);
+
+        {
+            auto&& testConveyor = jstd::conveyor<int, jstd::mpmc_queue<int> >([&](int&& value) { sum += value; },
+                                                                               options);
+
+            for (auto i = 1; i <= 1000; ++i)
+                testConveyor.push(int(i));
+        }
+
+    EXPECT_EQ(500500, sum);
+    }
+
+    TEST(UnitTest_affinity, growingQueueRejectsNumaNode)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.numa_node = 0;
+
+    EXPECT_THROW(jstd::conveyor<int>([](int&&) {}, options), std::invalid_argument);
+    EXPECT_THROW((jstd::conveyor<int, jstd::mpsc_queue<int> >([](int&&) {}, options)), std::invalid_argument);
+    }
+
+    TEST(UnitTest_affinity, nodeMemory)
+    {
+        auto&& memory = jstd::internal::node_memory(1 << 16, 0);
+        auto&& heap = jstd::internal::node_memory(64, -1);
+
+        // The memory is usable, whether or not the kernel accepted the node.
+        std::fill_n(static_cast<char*>(memory.get()), memory.size(), 'a');
+        std::fill_n(static_cast<char*>(heap.get()), heap.size(), 'b');
+
+    EXPECT_EQ('a', static_cast<char*>(memory.get())[(1 << 16) - 1]);
+    EXPECT_EQ('b', static_cast<char*>(heap.get())[63]);
+    EXPECT_FALSE(heap.placed());
+    }
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <concurrency/batch_conveyor.h>
+
+using jstd::batch_conveyor;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    TEST(UnitTest_batch_conveyor, pushAndWait)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor = batch_conveyor<std::string>([&](std::vector<std::string>&& batch)
+                                                              {
+                                                                  for (auto& value : batch)
+                                                                      results.push_back(std::move(value));
+                                                              });
+
+            const auto value3 = "value3"s;
+
+            testConveyor.push("value1"s);
+            testConveyor.push("value2"s);
+            testConveyor.push(value3);
+            testConveyor.push("value4"s);
+            testConveyor.push("value5"s);
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s, "value4"s, "value5"s));
+    }
+
+    template <typename Queue>
+    void testBatchesPendingValues()
+    {
+        auto&& batchSizes = std::vector<std::size_t>();
+        auto&& started = std::promise<void>();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        {
+            auto&& testConveyor = batch_conveyor<int, Queue>([&](std::vector<int>&& batch)
+                                                             {
+                                                                 if (batchSizes.empty())
+                                                                     started.set_value();
+
+                                                                 released.wait();
+                                                                 batchSizes.push_back(batch.size());
+                                                             });
+
+            testConveyor.push(0);
+            started.get_future().wait();
+
+            for (auto i = 1; i <= 100; ++i)
+                testConveyor.push(int(i));
+
+            release.set_value();
+        }
+
+    EXPECT_THAT(batchSizes, ElementsAre(1, 100));
+    }
+
+    TEST(UnitTest_batch_conveyor, batchesPendingValues)
+    {
+        testBatchesPendingValues<jstd::blocking_queue<int> >();
+    }
+
+    TEST(UnitTest_batch_conveyor, batchesPendingValues_spscQueue)
+    {
+        testBatchesPendingValues<jstd::spsc_queue<int> >();
+    }
+
+    TEST(UnitTest_batch_conveyor, limitsBatchSize)
+    {
+        auto&& batchSizes = std::vector<std::size_t>();
+        auto&& started = std::promise<void>();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        auto&& options = jstd::conveyor_options();
+        options.batch_size = 4;
+
+        {
+            auto&& testConveyor = batch_conveyor<int>([&](std::vector<int>&& batch)
+                                                      {
+                                                          if (batchSizes.empty())
+                                                              started.set_value();
+
+                                                          released.wait();
+                                                          batchSizes.push_back(batch.size());
+                                                      },
+                                                      options);
+
+            testConveyor.push(0);
+            started.get_future().wait();
+
+            for (auto i = 1; i <= 10; ++i)
+                testConveyor.push(int(i));
+
+            release.set_value();
+        }
+
+    EXPECT_THAT(batchSizes, ElementsAre(1, 4, 4, 2));
+    }
+
+    TEST(UnitTest_batch_conveyor, delayCollectsValues)
+    {
+        auto&& batchSizes = std::vector<std::size_t>();
+        auto&& passed = std::promise<void>();
+
+        auto&& options = jstd::conveyor_options();
+        options.batch_delay = std::chrono::milliseconds(100);
+
+        {
+            auto&& testConveyor = batch_conveyor<int>([&](std::vector<int>&& batch)
+                                                      {
+                                                          batchSizes.push_back(batch.size());
+                                                          passed.set_value();
+                                                      },
+                                                      options);
+
+            const auto start = std::chrono::steady_clock::now();
+
+            testConveyor.push(1);
+            testConveyor.push(2);
+            testConveyor.push(3);
+
+            passed.get_future().wait();
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+        }
+
+    EXPECT_THAT(batchSizes, ElementsAre(3));
+    }
+
+    TEST(UnitTest_batch_conveyor, sizeOrDelay)
+    {
+        auto&& results = std::vector<std::vector<int> >();
+
+        auto&& options = jstd::conveyor_options();
+        options.batch_size = 2;
+        options.batch_delay = std::chrono::hours(1);
+
+        {
+            auto&& testConveyor = batch_conveyor<int, jstd::spsc_queue<int> >(
+                    [&](std::vector<int>&& batch) { results.push_back(std::move(batch)); },
+                    options);
+
+            for (auto i = 1; i <= 5; ++i)
+                testConveyor.push(int(i));
+        }
+
+        // The incomplete batch is passed, when the conveyor is destroyed.
+    EXPECT_THAT(results, ElementsAre(ElementsAre(1, 2), ElementsAre(3, 4), ElementsAre(5)));
+    }
+
+    TEST(UnitTest_batch_conveyor, flush)
+    {
+        auto&& results = std::vector<int>();
+
+        auto&& options = jstd::conveyor_options();
+        options.batch_size = 3;
+
+        using ConveyorType = batch_conveyor<int, jstd::blocking_queue<int>, jstd::no_statistics, jstd::conveyor_flush>;
+
+        auto&& testConveyor = ConveyorType([&](std::vector<int>&& batch)
+                                           {
+                                               std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                               results.insert(results.end(), batch.begin(), batch.end());
+                                           },
+                                           options);
+
+        for (auto i = 0; i < 10; ++i)
+            testConveyor.push(int(i));
+
+        testConveyor.flush();
+    EXPECT_THAT(results, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+
+        testConveyor.push(10);
+
+        testConveyor.flush();
+    EXPECT_THAT(results, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10));
+    }
+
+    TEST(UnitTest_batch_conveyor, notCopyable)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor = batch_conveyor<std::unique_ptr<std::string> >(
+                    [&](std::vector<std::unique_ptr<std::string> >&& batch)
+                    {
+                        for (auto& value : batch)
+                            results.push_back(*value);
+                    });
+
+            testConveyor.push(std::make_unique<std::string>("value1"));
+            testConveyor.push(std::make_unique<std::string>("value2"));
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s));
+    }
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <concurrency/internal/chunked_queue.h>
+
+using jstd::internal::chunk_pool;
+using jstd::internal::chunked_queue;
+using jstd::internal::queue_chunk;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    template <typename T>
+    std::vector<T> popAll(chunked_queue<T>& queue)
+    {
+        auto&& results = std::vector<T>();
+
+        while (!queue.empty())
+        {
+            results.push_back(std::move(queue.front()));
+            queue.pop();
+        }
+
+        return results;
+    }
+
+    TEST(UnitTest_chunked_queue, pushAndPop)
+    {
+        auto&& pool = chunk_pool<std::string>();
+        auto&& queue = chunked_queue<std::string>(pool);
+
+    EXPECT_TRUE(queue.empty());
+
+        queue.emplace("value1"s);
+        queue.emplace(3, 'a');
+
+    EXPECT_EQ(2, queue.size());
+    EXPECT_THAT(popAll(queue), ElementsAre("value1"s, "aaa"s));
+    EXPECT_TRUE(queue.empty());
+    }
+
+    TEST(UnitTest_chunked_queue, spansChunks)
+    {
+        auto&& pool = chunk_pool<int>();
+        auto&& queue = chunked_queue<int>(pool);
+
+        const auto count = static_cast<int>(queue_chunk<int>::capacity * 3 + 1);
+
+        for (auto i = 0; i < count; ++i)
+            queue.emplace(i);
+
+    EXPECT_EQ(4, pool.allocated());
+
+        const auto results = popAll(queue);
+
+    ASSERT_EQ(count, results.size());
+        for (auto i = 0; i < count; ++i)
+    ASSERT_EQ(i, results[i]);
+    }
+
+    TEST(UnitTest_chunked_queue, reusesChunks)
+    {
+        auto&& pool = chunk_pool<int>();
+        auto&& queue = chunked_queue<int>(pool);
+
+        const auto count = static_cast<int>(queue_chunk<int>::capacity * 2);
+
+        for (auto round = 0; round < 10; ++round)
+        {
+            for (auto i = 0; i < count; ++i)
+                queue.emplace(i);
+
+            popAll(queue);
+        }
+
+    EXPECT_EQ(2, pool.allocated());
+    }
+
+    TEST(UnitTest_chunked_queue, swap)
+    {
+        auto&& pool = chunk_pool<std::string>();
+        auto&& queue = chunked_queue<std::string>(pool);
+        auto&& other = chunked_queue<std::string>(pool);
+
+        queue.emplace("value1"s);
+        queue.emplace("value2"s);
+
+        other.swap(queue);
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_THAT(popAll(other), ElementsAre("value1"s, "value2"s));
+    }
+
+    TEST(UnitTest_chunked_queue, destroysRemainingValues)
+    {
+        auto&& pool = chunk_pool<std::shared_ptr<int> >();
+        auto&& value = std::make_shared<int>(1);
+
+        {
+            auto&& queue = chunked_queue<std::shared_ptr<int> >(pool);
+
+            for (auto i = 0u; i < queue_chunk<std::shared_ptr<int> >::capacity + 1; ++i)
+                queue.emplace(value);
+
+            queue.pop();
+        }
+
+    EXPECT_EQ(1, value.use_count());
+    }
+
+    struct ThrowingValue
+    {
+        explicit ThrowingValue(int value)
+            : value(value)
+        {
+            if (value < 0)
+                throw std::runtime_error("TestError");
+        }
+
+        int value;
+    };
+
+    TEST(UnitTest_chunked_queue, throwingConstructor)
+    {
+        auto&& pool = chunk_pool<ThrowingValue>();
+        auto&& queue = chunked_queue<ThrowingValue>(pool);
+
+        const auto capacity = static_cast<int>(queue_chunk<ThrowingValue>::capacity);
+
+        for (auto i = 0; i < capacity; ++i)
+            queue.emplace(i);
+
+    EXPECT_THROW(queue.emplace(-1), std::runtime_error);
+    EXPECT_EQ(capacity, queue.size());
+
+        for (auto i = 0; i < capacity; ++i)
+        {
+    ASSERT_EQ(i, queue.front().value);
+            queue.pop();
+        }
+
+        queue.emplace(capacity);
+
+    EXPECT_EQ(capacity, queue.front().value);
+    EXPECT_EQ(1, queue.size());
+    }
+}
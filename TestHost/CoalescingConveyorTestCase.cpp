@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <future>
+
+#include <concurrency/coalescing_conveyor.h>
+
+using jstd::coalescing_conveyor;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    using Quote = std::pair<std::string, int>;
+
+    std::string symbolOf(const Quote& quote)
+    {
+        return quote.first;
+    }
+
+    TEST(UnitTest_coalescing_conveyor, pushAndWait)
+    {
+        auto&& results = std::vector<Quote>();
+
+        {
+            auto&& testConveyor = coalescing_conveyor<Quote, std::string>(
+                    symbolOf, [&](Quote&& quote) { results.push_back(std::move(quote)); });
+
+            const auto quote = Quote("b", 2);
+
+            testConveyor.push(Quote("a", 1));
+            testConveyor.push(quote);
+        }
+
+    EXPECT_THAT(results, ElementsAre(Quote("a", 1), Quote("b", 2)));
+    }
+
+    TEST(UnitTest_coalescing_conveyor, replacesPendingValues)
+    {
+        auto&& results = std::vector<Quote>();
+        auto&& started = std::promise<void>();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        {
+            auto&& testConveyor = coalescing_conveyor<Quote, std::string>(
+                    symbolOf,
+                    [&](Quote&& quote)
+                    {
+                        if (results.empty())
+                        {
+                            started.set_value();
+                            released.wait();
+                        }
+
+                        results.push_back(std::move(quote));
+                    });
+
+            testConveyor.push(Quote("a", 0));
+            started.get_future().wait();
+
+            for (auto i = 1; i <= 100; ++i)
+            {
+                testConveyor.push(Quote("b", i));
+                testConveyor.push(Quote("a", i));
+                testConveyor.push(Quote("c", i));
+            }
+
+            release.set_value();
+        }
+
+    EXPECT_THAT(results, ElementsAre(Quote("a", 0), Quote("b", 100), Quote("a", 100), Quote("c", 100)));
+    }
+
+    TEST(UnitTest_coalescing_conveyor, mergesPendingValues)
+    {
+        auto&& results = std::vector<Quote>();
+        auto&& started = std::promise<void>();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        {
+            auto&& testConveyor = coalescing_conveyor<Quote, std::string>(
+                    symbolOf,
+                    [&](Quote&& quote)
+                    {
+                        if (results.empty())
+                        {
+                            started.set_value();
+                            released.wait();
+                        }
+
+                        results.push_back(std::move(quote));
+                    },
+                    [](Quote& pending, Quote&& update) { pending.second += update.second; });
+
+            testConveyor.push(Quote("a", 0));
+            started.get_future().wait();
+
+            for (auto i = 1; i <= 10; ++i)
+                testConveyor.push(Quote("a", i));
+
+            release.set_value();
+        }
+
+    EXPECT_THAT(results, ElementsAre(Quote("a", 0), Quote("a", 55)));
+    }
+
+    TEST(UnitTest_coalescing_conveyor, capacityLimitsPendingKeys)
+    {
+        auto&& results = std::vector<Quote>();
+        auto&& started = std::promise<void>();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 2;
+
+        {
+            auto&& testConveyor = coalescing_conveyor<Quote, std::string>(
+                    symbolOf,
+                    [&](Quote&& quote)
+                    {
+                        if (results.empty())
+                        {
+                            started.set_value();
+                            released.wait();
+                        }
+
+                        results.push_back(std::move(quote));
+                    },
+                    options);
+
+            testConveyor.push(Quote("a", 0));
+            started.get_future().wait();
+
+            auto&& quote = Quote("c", 1);
+
+        EXPECT_TRUE(testConveyor.try_push(Quote("a", 1)));
+        EXPECT_TRUE(testConveyor.try_push(Quote("b", 1)));
+        EXPECT_FALSE(testConveyor.try_push(std::move(quote)));
+        EXPECT_EQ("c", quote.first);
+        EXPECT_FALSE(testConveyor.push_for(quote, std::chrono::milliseconds(1)));
+        EXPECT_FALSE(testConveyor.push_until(quote, std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+        EXPECT_TRUE(testConveyor.try_push(Quote("b", 2)));
+
+            release.set_value();
+
+            testConveyor.push(quote);
+        }
+
+    EXPECT_THAT(results, ElementsAre(Quote("a", 0), Quote("a", 1), Quote("b", 2), Quote("c", 1)));
+    }
+
+    TEST(UnitTest_coalescing_conveyor, mergeThrows)
+    {
+        auto&& results = std::vector<Quote>();
+        auto&& started = std::promise<void>();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        {
+            auto&& testConveyor = coalescing_conveyor<Quote, std::string>(
+                    symbolOf,
+                    [&](Quote&& quote)
+                    {
+                        if (results.empty())
+                        {
+                            started.set_value();
+                            released.wait();
+                        }
+
+                        results.push_back(std::move(quote));
+                    },
+                    [](Quote& pending, Quote&& update)
+                    {
+                        if (update.second < 0)
+                            throw std::runtime_error("TestError");
+
+                        pending.second += update.second;
+                    });
+
+            testConveyor.push(Quote("a", 0));
+            started.get_future().wait();
+
+            testConveyor.push(Quote("a", 1));
+
+            // The exception is thrown by the push and the pending value and its key stay usable.
+        EXPECT_THROW(testConveyor.push(Quote("a", -1)), std::runtime_error);
+        EXPECT_TRUE(testConveyor.try_push(Quote("a", 2)));
+        EXPECT_TRUE(testConveyor.try_push(Quote("b", 1)));
+
+            release.set_value();
+        }
+
+    EXPECT_THAT(results, ElementsAre(Quote("a", 0), Quote("a", 3), Quote("b", 1)));
+    }
+
+    TEST(UnitTest_coalescing_conveyor, processorThrows)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 1;
+
+        auto&& testConveyor = coalescing_conveyor<int, int>([](const int& value) { return value; },
+                                                           [](int&&) { throw std::runtime_error("TestError"); },
+                                                           options);
+
+        // A producer does not wait for a conveyor, that stopped processing.
+        for (auto i = 0; i < 100; ++i)
+            testConveyor.push(int(i));
+    }
+}
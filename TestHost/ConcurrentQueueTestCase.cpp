@@ -0,0 +1,493 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <concurrency/blocking_queue.h>
+#include <concurrency/mpmc_queue.h>
+#include <concurrency/mpsc_queue.h>
+#include <concurrency/spsc_queue.h>
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    template <typename Queue>
+    std::vector<typename Queue::value_type> popAll(Queue& queue)
+    {
+        auto&& results = std::vector<typename Queue::value_type>();
+
+        while (queue.pop([&](typename Queue::value_type&& value) { results.push_back(std::move(value)); }));
+
+        return results;
+    }
+
+    template <typename T>
+    class UnitTest_concurrent_queue : public testing::Test
+    {
+    };
+
+    using ConcurrentQueueTypes = ::testing::Types<
+            jstd::blocking_queue<std::string>,
+            jstd::mpmc_queue<std::string>,
+            jstd::mpsc_queue<std::string>,
+            jstd::spsc_queue<std::string>,
+            jstd::mpmc_queue<std::string, jstd::spin_wait<> >,
+            jstd::mpsc_queue<std::string, jstd::spin_wait<> >,
+            jstd::spsc_queue<std::string, jstd::busy_wait> >;
+
+    TYPED_TEST_CASE(UnitTest_concurrent_queue, ConcurrentQueueTypes);
+
+    TYPED_TEST(UnitTest_concurrent_queue, pushAndPop)
+    {
+        auto&& queue = TypeParam();
+
+        EXPECT_TRUE(queue.push("value1"s));
+        EXPECT_TRUE(queue.push("value2"s));
+        EXPECT_TRUE(queue.push("value3"s));
+
+        queue.close();
+
+    EXPECT_THAT(popAll(queue), ElementsAre("value1"s, "value2"s, "value3"s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, emplace)
+    {
+        auto&& queue = TypeParam();
+
+        EXPECT_TRUE(queue.emplace(3, 'a'));
+        EXPECT_TRUE(queue.emplace("value"));
+        EXPECT_TRUE(queue.emplace());
+
+        queue.close();
+
+    EXPECT_THAT(popAll(queue), ElementsAre("aaa"s, "value"s, ""s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, consumerThrows)
+    {
+        auto&& queue = TypeParam();
+
+        queue.push("value1"s);
+        queue.push("value2"s);
+        queue.push("value3"s);
+        queue.push("value4"s);
+        queue.close();
+
+        const auto throwing = [](std::string&&) { throw std::runtime_error("TestError"); };
+
+    EXPECT_THROW(queue.pop(throwing), std::runtime_error);
+    EXPECT_THROW(queue.pop_all(throwing), std::runtime_error);
+
+        auto&& results = std::vector<std::string>();
+
+        while (queue.pop_all([&](std::string&& value) { results.push_back(std::move(value)); }));
+
+    EXPECT_THAT(results, ElementsAre("value3"s, "value4"s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, pushAfterClose)
+    {
+        auto&& queue = TypeParam();
+
+        queue.close();
+
+    EXPECT_FALSE(queue.push("value1"s));
+    EXPECT_THAT(popAll(queue), IsEmpty());
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, popWaitsForClose)
+    {
+        auto&& queue = TypeParam();
+
+        auto&& consumer = std::async(std::launch::async, [&] { return popAll(queue); });
+
+        queue.push("value1"s);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.push("value2"s);
+        queue.close();
+
+    EXPECT_THAT(consumer.get(), ElementsAre("value1"s, "value2"s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, producerAndConsumerThread)
+    {
+        auto&& queue = TypeParam();
+        const auto count = 100000;
+
+        auto&& consumer = std::async(std::launch::async, [&] { return popAll(queue); });
+
+        for (auto i = 0; i < count; ++i)
+            queue.push(std::to_string(i));
+
+        queue.close();
+
+        const auto results = consumer.get();
+
+    ASSERT_EQ(count, results.size());
+        for (auto i = 0; i < count; ++i)
+    ASSERT_EQ(std::to_string(i), results[i]);
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, popAllPendingValues)
+    {
+        auto&& queue = TypeParam();
+
+        queue.push("value1"s);
+        queue.push("value2"s);
+        queue.push("value3"s);
+
+        auto&& results = std::vector<std::string>();
+        const auto consume = [&](std::string&& value) { results.push_back(std::move(value)); };
+
+    EXPECT_TRUE(queue.pop_all(consume));
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s));
+
+        queue.push("value4"s);
+        queue.close();
+
+    EXPECT_TRUE(queue.pop_all(consume));
+    EXPECT_FALSE(queue.pop_all(consume));
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s, "value4"s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, tryPushWhileFull)
+    {
+        auto&& queue = TypeParam(2);
+
+    EXPECT_TRUE(queue.try_push("value1"s));
+    EXPECT_TRUE(queue.try_push("value2"s));
+
+        auto&& value3 = "value3"s;
+    EXPECT_FALSE(queue.try_push(std::move(value3)));
+    EXPECT_EQ("value3"s, value3);
+
+        queue.pop([](std::string&&) {});
+    EXPECT_TRUE(queue.try_push(std::move(value3)));
+
+        queue.close();
+
+    EXPECT_THAT(popAll(queue), ElementsAre("value2"s, "value3"s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, pushUntilWhileFull)
+    {
+        auto&& queue = TypeParam(2);
+
+        queue.push("value1"s);
+        queue.push("value2"s);
+
+        const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.push_until("value3"s, start + std::chrono::milliseconds(20)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+        auto&& consumer = std::async(std::launch::async, [&]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            queue.pop([](std::string&&) {});
+        });
+
+    EXPECT_TRUE(queue.push_until("value3"s, std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+
+        consumer.wait();
+        queue.close();
+
+    EXPECT_THAT(popAll(queue), ElementsAre("value2"s, "value3"s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, popAllUntilDeadline)
+    {
+        auto&& queue = TypeParam();
+
+        auto&& results = std::vector<std::string>();
+        const auto consume = [&](std::string&& value) { results.push_back(std::move(value)); };
+
+        const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(queue.pop_all_until(consume, start + std::chrono::milliseconds(20)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_TRUE(results.empty());
+
+        auto&& producer = std::async(std::launch::async, [&]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            queue.push("value1"s);
+        });
+
+        while (results.empty())
+    ASSERT_TRUE(queue.pop_all_until(consume, std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+
+        producer.wait();
+    EXPECT_THAT(results, ElementsAre("value1"s));
+
+        queue.push("value2"s);
+        queue.close();
+
+    EXPECT_TRUE(queue.pop_all_until(consume, std::chrono::steady_clock::now()));
+    EXPECT_FALSE(queue.pop_all_until(consume, std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s));
+    }
+
+    TYPED_TEST(UnitTest_concurrent_queue, closeReleasesWaitingProducer)
+    {
+        auto&& queue = TypeParam(2);
+
+        queue.push("value1"s);
+        queue.push("value2"s);
+
+        auto&& producer = std::async(std::launch::async, [&] { return queue.push("value3"s); });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        queue.close();
+
+    EXPECT_FALSE(producer.get());
+    EXPECT_THAT(popAll(queue), ElementsAre("value1"s, "value2"s));
+    }
+
+    template <typename T>
+    class UnitTest_multi_producer_queue : public testing::Test
+    {
+    };
+
+    using MultiProducerQueueTypes = ::testing::Types<
+            jstd::blocking_queue<std::pair<int, int> >,
+            jstd::mpmc_queue<std::pair<int, int> >,
+            jstd::mpsc_queue<std::pair<int, int> >,
+            jstd::mpsc_queue<std::pair<int, int>, jstd::spin_wait<> > >;
+
+    TYPED_TEST_CASE(UnitTest_multi_producer_queue, MultiProducerQueueTypes);
+
+    template <typename Queue>
+    void testMultipleProducers(Queue& queue)
+    {
+        const auto producerCount = 4;
+        const auto count = 20000;
+
+        auto&& consumer = std::async(std::launch::async, [&] { return popAll(queue); });
+
+        auto&& producers = std::vector<std::future<void> >();
+
+        for (auto producer = 0; producer < producerCount; ++producer)
+            producers.push_back(std::async(std::launch::async, [&queue, producer, count]
+            {
+                for (auto i = 0; i < count; ++i)
+                    queue.push(std::make_pair(producer, i));
+            }));
+
+        for (auto& producer : producers)
+            producer.wait();
+
+        queue.close();
+
+        auto&& next = std::vector<int>(producerCount, 0);
+
+        for (const auto& value : consumer.get())
+    ASSERT_EQ(next[value.first]++, value.second);
+
+    EXPECT_THAT(next, testing::Each(count));
+    }
+
+    TYPED_TEST(UnitTest_multi_producer_queue, multipleProducers)
+    {
+        auto&& queue = TypeParam();
+        testMultipleProducers(queue);
+    }
+
+    TYPED_TEST(UnitTest_multi_producer_queue, multipleProducers_bounded)
+    {
+        auto&& queue = TypeParam(16);
+        testMultipleProducers(queue);
+    }
+
+    template <typename T>
+    class UnitTest_multi_consumer_queue : public testing::Test
+    {
+    };
+
+    using MultiConsumerQueueTypes = ::testing::Types<
+            jstd::blocking_queue<int>,
+            jstd::mpmc_queue<int>,
+            jstd::mpmc_queue<int, jstd::spin_wait<> > >;
+
+    TYPED_TEST_CASE(UnitTest_multi_consumer_queue, MultiConsumerQueueTypes);
+
+    TYPED_TEST(UnitTest_multi_consumer_queue, multipleProducersAndConsumers)
+    {
+        auto&& queue = TypeParam(64);
+        const auto threadCount = 4;
+        const auto count = 20000;
+
+        auto&& consumers = std::vector<std::future<std::vector<int> > >();
+
+        for (auto consumer = 0; consumer < threadCount; ++consumer)
+            consumers.push_back(std::async(std::launch::async, [&] { return popAll(queue); }));
+
+        auto&& producers = std::vector<std::future<void> >();
+
+        for (auto producer = 0; producer < threadCount; ++producer)
+            producers.push_back(std::async(std::launch::async, [&queue, producer, count]
+            {
+                for (auto i = 0; i < count; ++i)
+                    queue.push(producer * count + i);
+            }));
+
+        for (auto& producer : producers)
+            producer.wait();
+
+        queue.close();
+
+        auto&& received = std::vector<int>(threadCount * count, 0);
+
+        for (auto& consumer : consumers)
+            for (const auto value : consumer.get())
+                ++received[value];
+
+        EXPECT_THAT(received, testing::Each(1));
+    }
+
+    TYPED_TEST(UnitTest_multi_consumer_queue, consumersWaitForClose)
+    {
+        const auto threadCount = 4;
+        const auto count = 200;
+
+        for (auto round = 0; round < 1000; ++round)
+        {
+            auto&& queue = TypeParam(16);
+            auto&& closed = std::atomic<bool>(false);
+            auto&& received = std::atomic<int>(0);
+
+            auto&& consumers = std::vector<std::future<bool> >();
+
+            for (auto consumer = 0; consumer < threadCount; ++consumer)
+                consumers.push_back(std::async(std::launch::async, [&]
+                {
+                    while (queue.pop([&](int) { ++received; }));
+
+                    return closed.load();
+                }));
+
+            for (auto i = 0; i < count; ++i)
+                queue.push(i);
+
+            while (received != count)
+                std::this_thread::yield();
+
+            closed = true;
+            queue.close();
+
+            for (auto& consumer : consumers)
+                ASSERT_TRUE(consumer.get());
+        }
+    }
+
+    TEST(UnitTest_blocking_queue, capacity)
+    {
+    EXPECT_EQ(0, jstd::blocking_queue<int>().capacity());
+    EXPECT_EQ(3, jstd::blocking_queue<int>(3).capacity());
+    }
+
+    TEST(UnitTest_mpsc_queue, destroysQueuedValues)
+    {
+        auto&& value = std::make_shared<int>(42);
+
+        {
+            auto&& queue = jstd::mpsc_queue<std::shared_ptr<int> >();
+
+            queue.push(value);
+            queue.push(value);
+            queue.push(value);
+            queue.pop([](std::shared_ptr<int>&&) {});
+
+    EXPECT_EQ(3, value.use_count());
+        }
+
+    EXPECT_EQ(1, value.use_count());
+    }
+
+    TEST(UnitTest_mpmc_queue, capacity)
+    {
+    EXPECT_EQ(jstd::mpmc_queue<int>::default_capacity, jstd::mpmc_queue<int>(0).capacity());
+    EXPECT_EQ(2, jstd::mpmc_queue<int>(1).capacity());
+    EXPECT_EQ(16, jstd::mpmc_queue<int>(9).capacity());
+    }
+
+    TEST(UnitTest_mpmc_queue, destroysQueuedValues)
+    {
+        auto&& value = std::make_shared<int>(42);
+
+        {
+            auto&& queue = jstd::mpmc_queue<std::shared_ptr<int> >(4);
+
+            queue.push(value);
+            queue.push(value);
+            queue.push(value);
+            queue.pop([](std::shared_ptr<int>&&) {});
+
+    EXPECT_EQ(3, value.use_count());
+        }
+
+    EXPECT_EQ(1, value.use_count());
+    }
+
+    TEST(UnitTest_spsc_queue, capacity)
+    {
+    EXPECT_EQ(jstd::spsc_queue<int>::default_capacity, jstd::spsc_queue<int>(0).capacity());
+    EXPECT_EQ(2, jstd::spsc_queue<int>(1).capacity());
+    EXPECT_EQ(8, jstd::spsc_queue<int>(8).capacity());
+    EXPECT_EQ(16, jstd::spsc_queue<int>(9).capacity());
+    EXPECT_EQ(jstd::spsc_queue<int>::default_capacity, jstd::spsc_queue<int>().capacity());
+    }
+
+    TEST(UnitTest_spsc_queue, producerWaitsWhileFull)
+    {
+        auto&& queue = jstd::spsc_queue<int>(4);
+        const auto count = 10000;
+
+        auto&& consumer = std::async(std::launch::async, [&]
+        {
+            auto&& results = std::vector<int>();
+
+            while (queue.pop([&](int&& value)
+                             {
+                                 if (value % 1000 == 0)
+                                     std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+                                 results.push_back(value);
+                             }));
+
+            return results;
+        });
+
+        for (auto i = 0; i < count; ++i)
+            queue.push(i);
+
+        queue.close();
+
+        const auto results = consumer.get();
+
+    ASSERT_EQ(count, results.size());
+        for (auto i = 0; i < count; ++i)
+    ASSERT_EQ(i, results[i]);
+    }
+
+    TEST(UnitTest_spsc_queue, destroysQueuedValues)
+    {
+        auto&& value = std::make_shared<int>(42);
+
+        {
+            auto&& queue = jstd::spsc_queue<std::shared_ptr<int> >(4);
+
+            queue.push(value);
+            queue.push(value);
+            queue.push(value);
+            queue.pop([](std::shared_ptr<int>&&) {});
+
+    EXPECT_EQ(3, value.use_count());
+        }
+
+    EXPECT_EQ(1, value.use_count());
+    }
+}
@@ -3,6 +3,11 @@
 
 #include <concurrency/conveyor_function.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 
 using namespace std::literals::string_literals;
 using testing::ElementsAre;
@@ -193,6 +198,27 @@ namespace
     EXPECT_THROW(jstd::conveyor_function(std::move(producer), std::move(consumer)), TestException);
     }
 
+    TEST(UnitTest_conveyor_function, boundedQueue_consumerThrows)
+    {
+        auto consumer = [](std::string&&)
+        {
+            throw TestException();
+        };
+
+        auto&& conveyor = jstd::internal::conveyor<std::string, decltype(consumer)>(std::move(consumer),
+                                                                                    jstd::conveyor_options{ 1 });
+
+        auto push = [&]
+        {
+            for (auto i = 0; i < 100; ++i)
+                conveyor.push("value"s);
+        };
+
+    EXPECT_THROW(push(), TestException);
+
+        conveyor.finish();
+    }
+
     TEST(UnitTest_conveyor_function, pipeline_simple)
     {
         auto results = std::vector<std::string>();
@@ -433,6 +459,456 @@ namespace
         const auto isSourceValid = std::is_same<CallableType::source_type, std::vector<std::string> >::value;
     EXPECT_TRUE(isSourceValid) << "converter_type::source is not std::vector<std::string>";
     }
+
+    TEST(UnitTest_conveyor_function, parallel_converter)
+    {
+        auto results = std::vector<std::string>();
+
+        auto producer = [](jstd::conveyor_forwarder<StringProducer>& forwarder)
+        {
+            for (auto i = size_t(1); i <= 5; ++i)
+                forwarder.push(StringProducer(i));
+        };
+
+        auto converter = [](StringProducer&& value, jstd::conveyor_forwarder<std::string>& forwarder)
+        {
+            forwarder.push(value.toString());
+        };
+
+        auto consumer = [&](std::string&& value)
+        {
+            results.push_back(std::move(value));
+        };
+
+        jstd::conveyor_function(producer, jstd::parallel(3, converter), consumer);
+
+        std::sort(results.begin(), results.end());
+    EXPECT_THAT(results, ElementsAre("A"s, "AA"s, "AAA"s, "AAAA"s, "AAAAA"s));
+    }
+
+    TEST(UnitTest_conveyor_function, parallel_consumer)
+    {
+        std::atomic<std::size_t> sum { 0 };
+
+        auto producer = [](jstd::conveyor_forwarder<std::size_t>& forwarder)
+        {
+            for (auto i = size_t(1); i <= 100; ++i)
+                forwarder.push(std::size_t(i));
+        };
+
+        jstd::conveyor_function(producer, jstd::parallel(4, [&](std::size_t&& value) { sum += value; }));
+
+    EXPECT_EQ(5050u, sum);
+    }
+
+    TEST(UnitTest_conveyor_function, parallel_constStage)
+    {
+        std::atomic<std::size_t> sum { 0 };
+
+        auto producer = [](jstd::conveyor_forwarder<std::size_t>& forwarder)
+        {
+            for (auto i = size_t(1); i <= 100; ++i)
+                forwarder.push(std::size_t(i));
+        };
+
+        auto doubler = [](std::size_t&& value, jstd::conveyor_forwarder<std::size_t>& forwarder)
+        {
+            forwarder.push(value * 2);
+        };
+
+        const auto converter = jstd::parallel(3, doubler);
+
+        const auto consumer = jstd::parallel(2, [&](std::size_t&& value) { sum += value; });
+
+        jstd::conveyor_function(producer, converter, consumer);
+        jstd::conveyor_function(producer, std::move(converter), std::move(consumer));
+
+    EXPECT_EQ(2 * 2 * 5050u, sum);
+    }
+
+    TEST(UnitTest_conveyor_function, parallel_runsConcurrently)
+    {
+        std::atomic<int> entered { 0 };
+        std::atomic<bool> overlapped { false };
+
+        auto producer = [](jstd::conveyor_forwarder<int>& forwarder)
+        {
+            forwarder.push(1);
+            forwarder.push(2);
+        };
+
+        // Every replica waits for the other one, which only succeeds if both run at the same time.
+        auto consumer = [&](int&&)
+        {
+            ++entered;
+
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (entered < 2 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+
+            if (entered == 2)
+                overlapped = true;
+        };
+
+        jstd::conveyor_function(producer, jstd::parallel(2, consumer));
+
+    EXPECT_TRUE(overlapped);
+    }
+
+    TEST(UnitTest_conveyor_function, parallel_zeroReplicas)
+    {
+        auto results = std::vector<int>();
+
+        auto producer = [](jstd::conveyor_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 3; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        jstd::conveyor_function(producer, jstd::parallel(0, [&](int&& value) { results.push_back(value); }));
+
+    EXPECT_THAT(results, ElementsAre(0, 1, 2));
+    }
+
+    TEST(UnitTest_conveyor_function, parallel_converter_throws)
+    {
+        auto producer = [](jstd::conveyor_forwarder<std::string>& forwarder)
+        {
+            for (auto i = size_t(1); i <= 100; ++i)
+                forwarder.push(std::string(i, 'A'));
+        };
+
+        auto converter = [](std::string&& value, jstd::conveyor_forwarder<std::string>& forwarder)
+        {
+            if (value.size() % 10 == 0)
+                throw TestException();
+
+            forwarder.push(std::move(value));
+        };
+
+    EXPECT_THROW(jstd::conveyor_function(producer, jstd::parallel(4, converter), [](std::string&&) {}),
+                 TestException);
+    }
+
+    TEST(UnitTest_conveyor_function, staticForwarder)
+    {
+        auto results = std::vector<std::string>();
+
+        auto producer = [](jstd::static_forwarder<std::size_t>& forwarder)
+        {
+            for (auto i = size_t(1); i <= 3; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        auto converter = [](std::size_t&& value, jstd::static_forwarder<std::string>& forwarder)
+        {
+            const auto text = std::string(value, 'A');
+            forwarder.push(text);
+        };
+
+        jstd::conveyor_function(producer, converter, [&](std::string&& value) { results.push_back(value); });
+
+    EXPECT_THAT(results, ElementsAre("A"s, "AA"s, "AAA"s));
+    }
+
+    TEST(UnitTest_conveyor_function, staticForwarder_mixed)
+    {
+        auto results = std::vector<std::unique_ptr<int> >();
+
+        auto producer = [](jstd::conveyor_forwarder<std::unique_ptr<int> >& forwarder)
+        {
+            forwarder.push(std::make_unique<int>(1));
+        };
+
+        auto converter = [](std::unique_ptr<int>&& value, jstd::static_forwarder<std::unique_ptr<int> >& forwarder)
+        {
+            ++*value;
+            forwarder.push(std::move(value));
+        };
+
+        jstd::conveyor_function(producer, converter, [&](std::unique_ptr<int>&& value)
+        {
+            results.push_back(std::move(value));
+        });
+
+    ASSERT_EQ(1u, results.size());
+    EXPECT_EQ(2, *results.front());
+    }
+
+    TEST(UnitTest_conveyor_function, staticForwarder_consumerThrows)
+    {
+        auto producer = [](jstd::static_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 1000; ++i)
+                forwarder.push(std::move(i));
+        };
+
+    EXPECT_THROW(jstd::conveyor_function(producer, [](int&&) { throw TestException(); }), TestException);
+    }
+
+    TEST(UnitTest_conveyor_function, callable_type_staticProducer)
+    {
+        auto input = [](jstd::static_forwarder<std::string>&) {};
+
+        using CallableType = jstd::internal::callable_type<decltype(input)>;
+
+        const auto callableType = CallableType::callable;
+    EXPECT_EQ(jstd::internal::Callable::producer, callableType);
+
+        const auto isTargetValid = std::is_same<CallableType::target_type, std::string>::value;
+    EXPECT_TRUE(isTargetValid) << "producer_type::target is not std::string";
+    }
+
+    TEST(UnitTest_conveyor_function, callable_type_staticConverter)
+    {
+        auto input = [](int&&, jstd::static_forwarder<std::string>&) {};
+
+        using CallableType = jstd::internal::callable_type<decltype(input)>;
+
+        const auto callableType = CallableType::callable;
+    EXPECT_EQ(jstd::internal::Callable::converter, callableType);
+
+        const auto isSourceValid = std::is_same<CallableType::source_type, int>::value;
+    EXPECT_TRUE(isSourceValid) << "converter_type::source is not int";
+
+        const auto isTargetValid = std::is_same<CallableType::target_type, std::string>::value;
+    EXPECT_TRUE(isTargetValid) << "converter_type::target is not std::string";
+    }
+
+    TEST(UnitTest_conveyor_function, fuse_converters)
+    {
+        auto results = std::vector<std::string>();
+        auto threads = std::vector<std::thread::id>(2);
+
+        auto producer = [](jstd::conveyor_forwarder<std::size_t>& forwarder)
+        {
+            for (auto i = size_t(0); i < 6; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        // A filter and a projection, that are called on the same thread.
+        auto filter = [&](std::size_t&& value, jstd::conveyor_forwarder<std::size_t>& forwarder)
+        {
+            threads[0] = std::this_thread::get_id();
+
+            if (value % 2 == 0)
+                forwarder.push(std::move(value));
+        };
+
+        auto project = [&](std::size_t&& value, jstd::conveyor_forwarder<std::string>& forwarder)
+        {
+            threads[1] = std::this_thread::get_id();
+            forwarder.push(std::string(value, 'A'));
+        };
+
+        jstd::conveyor_function(producer, jstd::fuse(filter, project),
+                                [&](std::string&& value) { results.push_back(value); });
+
+    EXPECT_THAT(results, ElementsAre(""s, "AA"s, "AAAA"s));
+    EXPECT_EQ(threads[0], threads[1]);
+    EXPECT_NE(std::this_thread::get_id(), threads[0]);
+    }
+
+    TEST(UnitTest_conveyor_function, fuse_consumer)
+    {
+        auto results = std::vector<int>();
+
+        auto producer = [](jstd::static_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 3; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        auto duplicate = [](int&& value, jstd::conveyor_forwarder<int>& forwarder)
+        {
+            forwarder.push(value);
+            forwarder.push(value * 10);
+        };
+
+        auto increment = [](int&& value, jstd::conveyor_forwarder<int>& forwarder) { forwarder.push(value + 1); };
+        auto consumer = [&](int&& value) { results.push_back(value); };
+
+        jstd::conveyor_function(producer, jstd::fuse(duplicate, increment, consumer));
+
+    EXPECT_THAT(results, ElementsAre(1, 1, 2, 11, 3, 21));
+    }
+
+    TEST(UnitTest_conveyor_function, fuse_callsFollowingCallableDirectly)
+    {
+        auto pending = 0;
+        auto results = std::vector<int>();
+
+        auto producer = [](jstd::static_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 3; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        // The push returns only after the following callable has taken the value.
+        auto converter = [&](int&& value, jstd::conveyor_forwarder<int>& forwarder)
+        {
+            ++pending;
+            forwarder.push(std::move(value));
+            results.push_back(pending);
+        };
+
+        auto last = [&](int&& value, jstd::static_forwarder<int>& forwarder)
+        {
+            --pending;
+            forwarder.push(std::move(value));
+        };
+
+        jstd::conveyor_function(producer, jstd::fuse(converter, last), [](int&&) {});
+
+    EXPECT_THAT(results, ElementsAre(0, 0, 0));
+    }
+
+    TEST(UnitTest_conveyor_function, fuse_staticForwarder)
+    {
+        auto results = std::vector<int>();
+        auto threads = std::vector<std::thread::id>(2);
+
+        auto producer = [](jstd::static_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 3; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        auto duplicate = [&](int&& value, jstd::static_forwarder<int>& forwarder)
+        {
+            threads[0] = std::this_thread::get_id();
+
+            forwarder.push(value);
+            forwarder.push(value * 10);
+        };
+
+        auto increment = [&](int&& value, jstd::static_forwarder<int>& forwarder)
+        {
+            threads[1] = std::this_thread::get_id();
+            forwarder.push(value + 1);
+        };
+
+        auto consumer = [&](int&& value) { results.push_back(value); };
+
+        jstd::conveyor_function(producer, jstd::fuse(duplicate, increment, consumer));
+
+    EXPECT_THAT(results, ElementsAre(1, 1, 2, 11, 3, 21));
+    EXPECT_EQ(threads[0], threads[1]);
+    }
+
+    TEST(UnitTest_conveyor_function, fuse_staticForwarderThrows)
+    {
+        auto results = std::vector<int>();
+
+        auto producer = [](jstd::static_forwarder<int>& forwarder) { forwarder.push(1); };
+
+        // The value forwarded before the exception still reaches the following callable.
+        auto converter = [](int&& value, jstd::static_forwarder<int>& forwarder)
+        {
+            forwarder.push(std::move(value));
+            throw TestException();
+        };
+
+        auto consumer = [&](int&& value) { results.push_back(value); };
+
+    EXPECT_THROW(jstd::conveyor_function(producer, jstd::fuse(converter, consumer)), TestException);
+    EXPECT_THAT(results, ElementsAre(1));
+    }
+
+    TEST(UnitTest_conveyor_function, fuse_callable_type)
+    {
+        auto converter = [](int&&, jstd::conveyor_forwarder<std::string>&) {};
+        auto consumer = [](std::string&&) {};
+
+        using ConverterType = jstd::internal::callable_type<decltype(jstd::fuse(converter, converter))>;
+        using ConsumerType = jstd::internal::callable_type<decltype(jstd::fuse(converter, consumer))>;
+
+        const auto converterCallable = ConverterType::callable;
+        const auto consumerCallable = ConsumerType::callable;
+    EXPECT_EQ(jstd::internal::Callable::converter, converterCallable);
+    EXPECT_EQ(jstd::internal::Callable::consumer, consumerCallable);
+
+        const auto isSourceValid = std::is_same<ConsumerType::source_type, int>::value;
+    EXPECT_TRUE(isSourceValid) << "consumer_type::source is not int";
+    }
+
+    TEST(UnitTest_conveyor_function, fuse_throws)
+    {
+        auto producer = [](jstd::conveyor_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 10; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        auto converter = [](int&& value, jstd::conveyor_forwarder<int>& forwarder) { forwarder.push(+value); };
+
+        auto consumer = [](int&& value)
+        {
+            if (value == 5)
+                throw TestException();
+        };
+
+    EXPECT_THROW(jstd::conveyor_function(producer, jstd::parallel(2, jstd::fuse(converter, consumer))),
+                 TestException);
+    }
+
+    TEST(UnitTest_conveyor_function, capacity_backpressure)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 2;
+
+        std::atomic<int> pushed { 0 };
+        std::atomic<int> consumed { 0 };
+        std::atomic<int> maxAhead { 0 };
+
+        auto producer = [&](jstd::static_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 50; ++i)
+            {
+                forwarder.push(std::move(i));
+                ++pushed;
+            }
+        };
+
+        auto converter = [](int&& value, jstd::static_forwarder<int>& forwarder) { forwarder.push(+value); };
+
+        // The producer can only be ahead of the slow consumer by the values that fit into the queues and the values
+        // that the stages took out of their queues, at most a queue full each.
+        auto consumer = [&](int&&)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            ++consumed;
+            maxAhead = std::max(maxAhead.load(), pushed - consumed);
+        };
+
+        jstd::conveyor_function(options, producer, converter, consumer);
+
+    EXPECT_EQ(50, consumed);
+    EXPECT_LE(maxAhead, 2 * 2 * 2);
+    }
+
+    TEST(UnitTest_conveyor_function, capacity_consumerThrows)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 1;
+
+        auto producer = [](jstd::conveyor_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 1000; ++i)
+                forwarder.push(std::move(i));
+        };
+
+        auto converter = [](int&& value, jstd::conveyor_forwarder<int>& forwarder) { forwarder.push(+value); };
+
+        // A blocked producer and converter are released by the failure of the consumer.
+        auto consumer = [](int&& value)
+        {
+            if (value == 10)
+                throw TestException();
+        };
+
+    EXPECT_THROW(jstd::conveyor_function(options, producer, converter, consumer), TestException);
+    }
     
 }
 
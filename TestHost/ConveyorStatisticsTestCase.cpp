@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <concurrency/conveyor.h>
+#include <concurrency/batch_conveyor.h>
+
+using jstd::latency_histogram;
+using namespace std::literals::string_literals;
+using namespace std::literals::chrono_literals;
+
+namespace
+{
+    TEST(UnitTest_latency_histogram, bucket)
+    {
+    EXPECT_EQ(0, latency_histogram::bucket(0));
+    EXPECT_EQ(1, latency_histogram::bucket(1));
+    EXPECT_EQ(2, latency_histogram::bucket(2));
+    EXPECT_EQ(2, latency_histogram::bucket(3));
+    EXPECT_EQ(3, latency_histogram::bucket(4));
+    EXPECT_EQ(11, latency_histogram::bucket(1024));
+    EXPECT_EQ(63, latency_histogram::bucket(std::numeric_limits<std::uint64_t>::max()));
+    }
+
+    TEST(UnitTest_latency_histogram, upperBound)
+    {
+    EXPECT_EQ(0ns, latency_histogram::upper_bound(0));
+    EXPECT_EQ(1ns, latency_histogram::upper_bound(1));
+    EXPECT_EQ(3ns, latency_histogram::upper_bound(2));
+    EXPECT_EQ(2047ns, latency_histogram::upper_bound(11));
+    EXPECT_EQ(std::chrono::nanoseconds::max(), latency_histogram::upper_bound(63));
+    }
+
+    TEST(UnitTest_latency_histogram, percentile)
+    {
+        auto&& histogram = latency_histogram();
+
+    EXPECT_EQ(0, histogram.count());
+    EXPECT_EQ(0ns, histogram.percentile(0.5));
+
+        histogram.buckets[latency_histogram::bucket(100)] = 90;
+        histogram.buckets[latency_histogram::bucket(5000)] = 9;
+        histogram.buckets[latency_histogram::bucket(100000)] = 1;
+
+    EXPECT_EQ(100, histogram.count());
+    EXPECT_EQ(127ns, histogram.percentile(0.5));
+    EXPECT_EQ(8191ns, histogram.percentile(0.95));
+    EXPECT_EQ(131071ns, histogram.percentile(0.999));
+    EXPECT_EQ(131071ns, histogram.percentile(1.0));
+    }
+
+    TEST(UnitTest_conveyor_statistics, conveyor)
+    {
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        using stats_conveyor = jstd::conveyor<std::string,
+                                              jstd::blocking_queue<std::string>,
+                                              std::function<void(std::string&&)>,
+                                              jstd::conveyor_statistics>;
+
+        auto&& testConveyor = stats_conveyor([&](std::string&& value)
+                                             {
+                                                 if (value == "block")
+                                                     released.wait();
+                                             });
+
+        testConveyor.push("block"s);
+        testConveyor.push("value1"s);
+
+        const auto value = "value2"s;
+        testConveyor.push(value);
+
+        auto&& stats = testConveyor.stats();
+
+    EXPECT_EQ(3, stats.pushed);
+    EXPECT_EQ(0, stats.processed);
+    EXPECT_EQ(3, stats.depth());
+
+        std::this_thread::sleep_for(2ms);
+        release.set_value();
+
+        while (testConveyor.stats().processed != 3)
+            std::this_thread::yield();
+
+        stats = testConveyor.stats();
+
+    EXPECT_EQ(3, stats.pushed);
+    EXPECT_EQ(0, stats.depth());
+    EXPECT_EQ(3, stats.wait_histogram.count());
+    EXPECT_EQ(3, stats.service_histogram.count());
+    EXPECT_LE(2ms, stats.service_time);
+    EXPECT_LE(4ms, stats.wait_time);
+    EXPECT_LE(2ms, stats.service_histogram.percentile(1.0));
+    }
+
+    TEST(UnitTest_conveyor_statistics, conveyor_rejectedValuesAreNotCounted)
+    {
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 1;
+
+        auto&& testConveyor = jstd::make_conveyor<int, jstd::spsc_queue<int>, jstd::conveyor_statistics>(
+                [&](int&&) { released.wait(); }, options);
+
+        testConveyor->push(0);
+
+        while (testConveyor->stats().wait_histogram.count() != 1)
+            std::this_thread::yield();
+
+        // The capacity of the spsc_queue is rounded up to two values. The processor consumes the first value
+        // in place, so there is room for one more.
+        testConveyor->push(0);
+
+        auto&& value = 1;
+
+    EXPECT_FALSE(testConveyor->try_push(value));
+    EXPECT_FALSE(testConveyor->push_for(std::move(value), 1ms));
+    EXPECT_EQ(2, testConveyor->stats().pushed);
+
+        release.set_value();
+    }
+
+    TEST(UnitTest_conveyor_statistics, conveyor_multipleThreads)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.threads = 4;
+
+        auto&& testConveyor = jstd::make_conveyor<int, jstd::mpmc_queue<int>, jstd::conveyor_statistics>(
+                [](int&&) {}, options);
+
+        for (auto i = 0; i < 1000; ++i)
+            testConveyor->push(int(i));
+
+        while (testConveyor->stats().processed != 1000)
+            std::this_thread::yield();
+
+        auto&& stats = testConveyor->stats();
+
+    EXPECT_EQ(1000, stats.pushed);
+    EXPECT_EQ(1000, stats.wait_histogram.count());
+    EXPECT_EQ(1000, stats.service_histogram.count());
+    }
+
+    TEST(UnitTest_conveyor_statistics, conveyor_multipleProducers)
+    {
+        auto&& testConveyor = jstd::make_conveyor<int, jstd::mpsc_queue<int>, jstd::conveyor_statistics>(
+                [](int&&) {});
+
+        auto&& done = std::atomic<bool>(false);
+
+        // Values are counted as pushed before they can be counted as processed.
+        auto&& observer = std::async(std::launch::async, [&]
+        {
+            while (!done)
+            {
+                const auto stats = testConveyor->stats();
+
+                if (stats.processed > stats.pushed)
+                    return false;
+            }
+
+            return true;
+        });
+
+        auto&& producers = std::vector<std::future<void> >();
+
+        for (auto producer = 0; producer < 4; ++producer)
+            producers.push_back(std::async(std::launch::async, [&]
+            {
+                for (auto i = 0; i < 1000; ++i)
+                    testConveyor->push(int(i));
+            }));
+
+        for (auto& producer : producers)
+            producer.wait();
+
+        while (testConveyor->stats().processed != 4000)
+            std::this_thread::yield();
+
+        done = true;
+
+    EXPECT_TRUE(observer.get());
+    EXPECT_EQ(4000, testConveyor->stats().pushed);
+    }
+
+    TEST(UnitTest_conveyor_statistics, batchConveyor)
+    {
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        using stats_conveyor =
+                jstd::batch_conveyor<int, jstd::blocking_queue<int>, jstd::conveyor_statistics>;
+
+        auto&& testConveyor = stats_conveyor([&](std::vector<int>&& batch)
+                                             {
+                                                 if (batch.front() == 0)
+                                                     released.wait();
+                                             });
+
+        testConveyor.push(0);
+
+        while (testConveyor.stats().wait_histogram.count() != 1)
+            std::this_thread::yield();
+
+        for (auto i = 1; i < 5; ++i)
+            testConveyor.push(int(i));
+
+        release.set_value();
+
+        while (testConveyor.stats().processed != 5)
+            std::this_thread::yield();
+
+        auto&& stats = testConveyor.stats();
+
+    EXPECT_EQ(5, stats.pushed);
+    EXPECT_EQ(5, stats.wait_histogram.count());
+    EXPECT_EQ(2, stats.service_histogram.count());
+    }
+}
@@ -197,4 +197,457 @@ namespace
 
     EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s, "value4"s, "value5"s));
     }
+
+    TEST(UnitTest_conveyor, spscQueue)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor =
+                    conveyor<std::string, jstd::spsc_queue<std::string> >(
+                            [&](std::string&& value) { results.push_back(std::move(value)); });
+
+            testConveyor.push("value1"s);
+            testConveyor.push("value2"s);
+            testConveyor.push("value3"s);
+            testConveyor.push("value4"s);
+            testConveyor.push("value5"s);
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s, "value4"s, "value5"s));
+    }
+
+    TEST(UnitTest_conveyor, spscQueue_waitStrategy)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& spinConveyor =
+                    conveyor<std::string, jstd::spsc_queue<std::string, jstd::spin_wait<> > >(
+                            [&](std::string&& value) { results.push_back(std::move(value)); });
+
+            auto&& busyConveyor =
+                    conveyor<std::string, jstd::spsc_queue<std::string, jstd::busy_wait> >(
+                            [&](std::string&& value) { spinConveyor.push(std::move(value)); });
+
+            busyConveyor.push("value1"s);
+            busyConveyor.push("value2"s);
+            busyConveyor.push("value3"s);
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s));
+    }
+
+    TEST(UnitTest_conveyor, spscQueue_notCopyable)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor =
+                    conveyor<NotCopyable, jstd::spsc_queue<NotCopyable> >(
+                            [&](auto&& value) { results.push_back(static_cast<std::string>(value)); });
+
+            testConveyor.push(NotCopyable("value1"s));
+            testConveyor.push(NotCopyable("value2"s));
+            testConveyor.push(NotCopyable("value3"s));
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s));
+    }
+
+    TEST(UnitTest_conveyor, processorThrows)
+    {
+        auto&& processed = std::atomic_int(0);
+
+        {
+            auto&& testConveyor =
+                    conveyor<int, jstd::spsc_queue<int> >([&](int&&)
+                                                          {
+                                                              ++processed;
+                                                              throw std::runtime_error("TestError");
+                                                          });
+
+            for (auto i = 0; i < 10000; ++i)
+                testConveyor.push(int(i));
+        }
+
+    EXPECT_EQ(1, processed);
+    }
+
+    TEST(UnitTest_conveyor, bounded_tryPush)
+    {
+        auto&& results = std::vector<std::string>();
+        auto&& started = std::promise<void>();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        {
+            auto&& testConveyor = conveyor<std::string>([&](std::string&& value)
+                                                        {
+                                                            if (results.empty())
+                                                                started.set_value();
+
+                                                            released.wait();
+                                                            results.push_back(std::move(value));
+                                                        },
+                                                        jstd::conveyor_options{ 2 });
+
+            testConveyor.push("value1"s);
+            started.get_future().wait();
+
+    EXPECT_TRUE(testConveyor.try_push("value2"s));
+    EXPECT_TRUE(testConveyor.try_push("value3"s));
+
+            const auto value4 = "value4"s;
+    EXPECT_FALSE(testConveyor.try_push(value4));
+    EXPECT_FALSE(testConveyor.push_for("value5"s, std::chrono::milliseconds(10)));
+
+            release.set_value();
+
+    EXPECT_TRUE(testConveyor.push_until("value6"s, std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s, "value6"s));
+    }
+
+    TEST(UnitTest_conveyor, bounded_pushWaitsForProcessor)
+    {
+        auto&& results = std::vector<int>();
+
+        {
+            auto&& testConveyor =
+                    conveyor<int, jstd::spsc_queue<int> >([&](int&& value) { results.push_back(value); },
+                                                          jstd::conveyor_options{ 4 });
+
+            for (auto i = 0; i < 1000; ++i)
+                testConveyor.push(int(i));
+        }
+
+    ASSERT_EQ(1000, results.size());
+        for (auto i = 0; i < 1000; ++i)
+    ASSERT_EQ(i, results[i]);
+    }
+
+    TEST(UnitTest_conveyor, mpscQueue_multipleProducers)
+    {
+        auto&& sum = 0;
+
+        {
+            auto&& testConveyor = conveyor<int, jstd::mpsc_queue<int> >([&](int&& value) { sum += value; });
+
+            auto&& producers = std::vector<std::future<void> >();
+
+            for (auto producer = 0; producer < 4; ++producer)
+                producers.push_back(std::async(std::launch::async, [&]
+                {
+                    for (auto i = 1; i <= 1000; ++i)
+                        testConveyor.push(int(i));
+                }));
+
+            for (auto& producer : producers)
+                producer.wait();
+        }
+
+    EXPECT_EQ(4 * 500500, sum);
+    }
+
+    template <typename Queue>
+    void testMultipleThreads()
+    {
+        auto&& sum = std::atomic_int(0);
+        auto&& running = std::atomic_int(0);
+        auto&& maxRunning = std::atomic_int(0);
+
+        {
+            auto&& options = jstd::conveyor_options();
+            options.threads = 4;
+
+            auto&& testConveyor = conveyor<int, Queue>([&](int&& value)
+                                                       {
+                                                           auto current = ++running;
+                                                           auto max = maxRunning.load();
+
+                                                           while (current > max && !maxRunning.compare_exchange_weak(max, current));
+
+                                                           std::this_thread::sleep_for(std::chrono::microseconds(100));
+                                                           sum += value;
+                                                           --running;
+                                                       },
+                                                       options);
+
+            for (auto i = 1; i <= 1000; ++i)
+                testConveyor.push(int(i));
+        }
+
+    EXPECT_EQ(500500, sum);
+    EXPECT_GT(maxRunning, 1);
+    }
+
+    TEST(UnitTest_conveyor, multipleThreads)
+    {
+        testMultipleThreads<jstd::blocking_queue<int> >();
+    }
+
+    TEST(UnitTest_conveyor, multipleThreads_mpmcQueue)
+    {
+        testMultipleThreads<jstd::mpmc_queue<int> >();
+    }
+
+    TEST(UnitTest_conveyor, multipleThreads_singleConsumerQueue)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.threads = 2;
+
+        auto create = [&]
+        {
+            conveyor<int, jstd::spsc_queue<int> >([](int&&) {}, options);
+        };
+
+    EXPECT_THROW(create(), std::invalid_argument);
+    }
+
+    TEST(UnitTest_conveyor, makeConveyor)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor =
+                    jstd::make_conveyor<std::string>([&](std::string&& value) { results.push_back(std::move(value)); });
+
+            const auto value3 = "value3"s;
+
+            testConveyor->push("value1"s);
+            testConveyor->push("value2"s);
+            testConveyor->push(value3);
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s));
+    }
+
+    TEST(UnitTest_conveyor, makeConveyor_moveOnlyProcessor)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& prefix = std::make_unique<std::string>("prefix_");
+
+            auto&& testConveyor =
+                    jstd::make_conveyor<std::string, jstd::spsc_queue<std::string> >(
+                            [&results, prefix = std::move(prefix)](std::string&& value)
+                            {
+                                results.push_back(*prefix + value);
+                            });
+
+            testConveyor->push("value1"s);
+            testConveyor->push("value2"s);
+        }
+
+    EXPECT_THAT(results, ElementsAre("prefix_value1"s, "prefix_value2"s));
+    }
+
+    TEST(UnitTest_conveyor, makeConveyor_processorType)
+    {
+        auto processor = [](int&&) {};
+
+        using ConveyorType = decltype(jstd::make_conveyor<int>(processor))::element_type;
+
+        const auto isConcreteType =
+                std::is_same<ConveyorType, conveyor<int, jstd::blocking_queue<int>, decltype(processor)> >::value;
+    EXPECT_TRUE(isConcreteType);
+    }
+
+    class MoveCounting
+    {
+    public:
+        MoveCounting(std::string value, int& moves)
+            : value_(std::move(value))
+            , moves_(&moves)
+        {
+        }
+
+        MoveCounting(MoveCounting&& other)
+            : value_(std::move(other.value_))
+            , moves_(other.moves_)
+        {
+            ++*moves_;
+        }
+
+        const std::string& value() const
+        {
+            return value_;
+        }
+
+    private:
+        std::string value_;
+        int* moves_;
+    };
+
+    template <typename Queue>
+    void testEmplace()
+    {
+        auto&& results = std::vector<std::string>();
+        auto&& moves = 0;
+
+        {
+            auto&& testConveyor = jstd::make_conveyor<MoveCounting, Queue>(
+                    [&](MoveCounting&& value) { results.push_back(value.value()); });
+
+            testConveyor->emplace("value1"s, moves);
+            testConveyor->emplace("value2"s, moves);
+            testConveyor->emplace("value3"s, moves);
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s));
+    EXPECT_EQ(0, moves);
+    }
+
+    TEST(UnitTest_conveyor, emplace)
+    {
+        testEmplace<jstd::blocking_queue<MoveCounting> >();
+    }
+
+    TEST(UnitTest_conveyor, emplace_spscQueue)
+    {
+        testEmplace<jstd::spsc_queue<MoveCounting> >();
+    }
+
+    TEST(UnitTest_conveyor, emplace_mpscQueue)
+    {
+        testEmplace<jstd::mpsc_queue<MoveCounting> >();
+    }
+
+    TEST(UnitTest_conveyor, emplace_statistics)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor = jstd::make_conveyor<std::string,
+                                                      jstd::blocking_queue<std::string>,
+                                                      jstd::conveyor_statistics>(
+                    [&](std::string&& value) { results.push_back(std::move(value)); });
+
+            testConveyor->emplace(3, 'a');
+
+        EXPECT_EQ(1, testConveyor->stats().pushed);
+        }
+
+    EXPECT_THAT(results, ElementsAre("aaa"s));
+    }
+
+    template <typename Queue = jstd::blocking_queue<int> >
+    using flushable_conveyor =
+            conveyor<int, Queue, std::function<void(int&&)>, jstd::no_statistics, jstd::conveyor_flush>;
+
+    template <typename Queue>
+    void testFlush()
+    {
+        auto&& results = std::vector<int>();
+
+        auto&& testConveyor = flushable_conveyor<Queue>([&](int&& value)
+                                                        {
+                                                            std::this_thread::sleep_for(std::chrono::microseconds(100));
+                                                            results.push_back(value);
+                                                        });
+
+        for (auto i = 0; i < 20; ++i)
+            testConveyor.push(int(i));
+
+        testConveyor.flush();
+    ASSERT_EQ(20, results.size());
+
+        // The conveyor keeps running after the flush.
+        for (auto i = 20; i < 40; ++i)
+            testConveyor.push(int(i));
+
+        testConveyor.flush();
+    ASSERT_EQ(40, results.size());
+        for (auto i = 0; i < 40; ++i)
+    ASSERT_EQ(i, results[i]);
+    }
+
+    TEST(UnitTest_conveyor, flush)
+    {
+        testFlush<jstd::blocking_queue<int> >();
+    }
+
+    TEST(UnitTest_conveyor, flush_spscQueue)
+    {
+        testFlush<jstd::spsc_queue<int> >();
+    }
+
+    TEST(UnitTest_conveyor, flush_mpscQueue)
+    {
+        testFlush<jstd::mpsc_queue<int> >();
+    }
+
+    TEST(UnitTest_conveyor, flushAsync)
+    {
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        auto&& testConveyor = flushable_conveyor<>([&](int&&) { released.wait(); });
+
+    EXPECT_EQ(std::future_status::ready, testConveyor.flush_async().wait_for(std::chrono::seconds(0)));
+
+        testConveyor.push(1);
+        auto&& flushed = testConveyor.flush_async();
+
+    EXPECT_EQ(std::future_status::timeout, flushed.wait_for(std::chrono::milliseconds(10)));
+
+        release.set_value();
+
+    EXPECT_EQ(std::future_status::ready, flushed.wait_for(std::chrono::seconds(10)));
+    }
+
+    template <typename Queue>
+    void testFlushMultipleThreads()
+    {
+        auto&& sum = std::atomic_int(0);
+
+        auto&& options = jstd::conveyor_options();
+        options.threads = 4;
+
+        auto&& testConveyor = flushable_conveyor<Queue>([&](int&& value)
+                                                        {
+                                                            // Values finish out of order.
+                                                            const auto delay = std::chrono::microseconds(value % 7 * 50);
+                                                            std::this_thread::sleep_for(delay);
+                                                            sum += value;
+                                                        },
+                                                        options);
+
+        auto&& expected = 0;
+
+        for (auto round = 0; round < 5; ++round)
+        {
+            for (auto i = 1; i <= 100; ++i)
+            {
+                testConveyor.push(int(i));
+                expected += i;
+            }
+
+            testConveyor.flush();
+    ASSERT_EQ(expected, sum);
+        }
+    }
+
+    TEST(UnitTest_conveyor, flush_multipleThreads)
+    {
+        testFlushMultipleThreads<jstd::blocking_queue<int> >();
+    }
+
+    TEST(UnitTest_conveyor, flush_multipleThreads_mpmcQueue)
+    {
+        testFlushMultipleThreads<jstd::mpmc_queue<int> >();
+    }
+
+    TEST(UnitTest_conveyor, flush_processorThrows)
+    {
+        auto&& testConveyor = flushable_conveyor<>([&](int&&) { throw std::runtime_error("TestError"); });
+
+        testConveyor.push(1);
+        testConveyor.push(2);
+
+    EXPECT_EQ(std::future_status::ready, testConveyor.flush_async().wait_for(std::chrono::seconds(10)));
+    }
 }
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+// The coroutine conveyor is only available in C++20. CMake builds this file into jstlCoroutineTestHost.
+#if defined(__cpp_impl_coroutine)
+
+#include <concurrency/coroutine_conveyor.h>
+#include <concurrency/thread_pool.h>
+
+using jstd::coroutine_conveyor;
+using jstd::detached_task;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    detached_task produce(coroutine_conveyor<int>& conveyor, int first, int last, std::vector<bool>& pushed)
+    {
+        for (auto i = first; i <= last; ++i)
+            pushed.push_back(co_await conveyor.push(i));
+    }
+
+    detached_task consume(coroutine_conveyor<int>& conveyor, std::vector<int>& results, bool& finished)
+    {
+        while (auto value = co_await conveyor.pop())
+            results.push_back(*value);
+
+        finished = true;
+    }
+
+    TEST(UnitTest_coroutine_conveyor, pushAndPop)
+    {
+        auto&& conveyor = coroutine_conveyor<int>();
+        auto&& pushed = std::vector<bool>();
+        auto&& results = std::vector<int>();
+        auto&& finished = false;
+
+        produce(conveyor, 1, 3, pushed);
+        consume(conveyor, results, finished);
+
+    EXPECT_THAT(results, ElementsAre(1, 2, 3));
+    EXPECT_FALSE(finished);
+
+        conveyor.close();
+
+    EXPECT_TRUE(finished);
+    EXPECT_THAT(pushed, ElementsAre(true, true, true));
+    }
+
+    TEST(UnitTest_coroutine_conveyor, consumerWaitsForValues)
+    {
+        auto&& conveyor = coroutine_conveyor<int>();
+        auto&& pushed = std::vector<bool>();
+        auto&& results = std::vector<int>();
+        auto&& finished = false;
+
+        consume(conveyor, results, finished);
+
+    EXPECT_TRUE(results.empty());
+
+        produce(conveyor, 1, 2, pushed);
+
+    EXPECT_THAT(results, ElementsAre(1, 2));
+
+        conveyor.close();
+
+    EXPECT_TRUE(finished);
+    }
+
+    TEST(UnitTest_coroutine_conveyor, producerWaitsWhileFull)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 2;
+
+        auto&& conveyor = coroutine_conveyor<int>(options);
+        auto&& pushed = std::vector<bool>();
+        auto&& results = std::vector<int>();
+        auto&& finished = false;
+
+        produce(conveyor, 1, 5, pushed);
+
+    EXPECT_THAT(pushed, ElementsAre(true, true));
+
+        consume(conveyor, results, finished);
+
+    EXPECT_THAT(pushed, ElementsAre(true, true, true, true, true));
+    EXPECT_THAT(results, ElementsAre(1, 2, 3, 4, 5));
+
+        conveyor.close();
+    }
+
+    TEST(UnitTest_coroutine_conveyor, closeResumesProducer)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 1;
+
+        auto&& conveyor = coroutine_conveyor<int>(options);
+        auto&& pushed = std::vector<bool>();
+        auto&& results = std::vector<int>();
+        auto&& finished = false;
+
+        produce(conveyor, 1, 3, pushed);
+        conveyor.close();
+
+    EXPECT_THAT(pushed, ElementsAre(true, false, false));
+
+        consume(conveyor, results, finished);
+
+    EXPECT_THAT(results, ElementsAre(1));
+    EXPECT_TRUE(finished);
+    }
+
+    detached_task consumeStrings(coroutine_conveyor<std::unique_ptr<std::string> >& conveyor,
+                                 std::vector<std::string>& results)
+    {
+        while (auto value = co_await conveyor.pop())
+            results.push_back(**value);
+    }
+
+    TEST(UnitTest_coroutine_conveyor, notCopyable)
+    {
+        auto&& conveyor = coroutine_conveyor<std::unique_ptr<std::string> >();
+        auto&& results = std::vector<std::string>();
+
+        consumeStrings(conveyor, results);
+
+        [&]() -> detached_task
+        {
+            co_await conveyor.push(std::make_unique<std::string>("value1"));
+            co_await conveyor.emplace(new std::string("value2"));
+            conveyor.close();
+        }();
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s));
+    }
+
+    detached_task sumOnExecutor(coroutine_conveyor<int>& conveyor, std::atomic_int& sum, std::promise<void>& done)
+    {
+        while (auto value = co_await conveyor.pop())
+            sum += *value;
+
+        done.set_value();
+    }
+
+    detached_task produceOnExecutor(coroutine_conveyor<int>& conveyor, int count, std::promise<void>& done)
+    {
+        for (auto i = 1; i <= count; ++i)
+            co_await conveyor.push(i);
+
+        done.set_value();
+    }
+
+    TEST(UnitTest_coroutine_conveyor, manyConveyorsShareExecutor)
+    {
+        const auto count = 100;
+
+        auto&& pool = jstd::thread_pool(2);
+
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 4;
+        options.executor = &pool;
+
+        auto&& conveyors = std::vector<std::unique_ptr<coroutine_conveyor<int> > >();
+        auto&& sums = std::vector<std::atomic_int>(count);
+        auto&& consumed = std::vector<std::promise<void> >(count);
+        auto&& produced = std::vector<std::promise<void> >(count);
+
+        for (auto i = 0; i < count; ++i)
+        {
+            conveyors.push_back(std::make_unique<coroutine_conveyor<int> >(options));
+            sumOnExecutor(*conveyors.back(), sums[i], consumed[i]);
+        }
+
+        for (auto i = 0; i < count; ++i)
+            produceOnExecutor(*conveyors[i], 100, produced[i]);
+
+        // Producers and consumers are suspended and resumed on the two threads of the pool.
+        for (auto i = 0; i < count; ++i)
+        {
+            produced[i].get_future().wait();
+            conveyors[i]->close();
+            consumed[i].get_future().wait();
+        }
+
+        auto&& total = 0;
+
+        for (auto& sum : sums)
+            total += sum;
+
+    EXPECT_EQ(count * 5050, total);
+    }
+}
+
+#endif
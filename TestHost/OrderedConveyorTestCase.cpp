@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <future>
+#include <random>
+#include <thread>
+
+#include <concurrency/ordered_conveyor.h>
+#include <concurrency/spsc_queue.h>
+#include <concurrency/thread_pool.h>
+
+using jstd::ordered_conveyor;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    TEST(UnitTest_ordered_conveyor, pushAndWait)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor = ordered_conveyor<int, std::string>(
+                    [](int&& value) { return std::to_string(value); },
+                    [&](std::string&& value) { results.push_back(std::move(value)); });
+
+            const auto value3 = 3;
+
+            testConveyor.push(1);
+            testConveyor.push(2);
+            testConveyor.push(value3);
+            testConveyor.emplace(4);
+        }
+
+    EXPECT_THAT(results, ElementsAre("1"s, "2"s, "3"s, "4"s));
+    }
+
+    template <typename Queue>
+    void testKeepsOrder(std::size_t threads, std::size_t reorderCapacity)
+    {
+        const auto count = 2000;
+
+        auto&& results = std::vector<int>();
+        auto&& options = jstd::conveyor_options();
+        options.threads = threads;
+        options.capacity = 16;
+        options.reorder_capacity = reorderCapacity;
+
+        {
+            auto&& testConveyor = ordered_conveyor<int, int, Queue>(
+                    [](int&& value)
+                    {
+                        // Later values frequently overtake earlier ones.
+                        if (value % 7 == 0)
+                            std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+                        return value * 2;
+                    },
+                    [&](int&& value) { results.push_back(value); },
+                    options);
+
+            for (auto i = 0; i < count; ++i)
+                testConveyor.push(int(i));
+        }
+
+    ASSERT_EQ(count, results.size());
+
+        for (auto i = 0; i < count; ++i)
+    ASSERT_EQ(i * 2, results[i]);
+    }
+
+    TEST(UnitTest_ordered_conveyor, multipleThreads)
+    {
+        testKeepsOrder<jstd::blocking_queue<int> >(4, 0);
+    }
+
+    TEST(UnitTest_ordered_conveyor, multipleThreads_mpmcQueue)
+    {
+        testKeepsOrder<jstd::mpmc_queue<int> >(4, 0);
+    }
+
+    TEST(UnitTest_ordered_conveyor, multipleThreads_smallReorderBuffer)
+    {
+        testKeepsOrder<jstd::mpmc_queue<int> >(4, 1);
+    }
+
+    TEST(UnitTest_ordered_conveyor, singleThread_spscQueue)
+    {
+        testKeepsOrder<jstd::spsc_queue<int> >(1, 0);
+    }
+
+    TEST(UnitTest_ordered_conveyor, singleConsumerQueue)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.threads = 2;
+
+        auto createConveyor = [&]
+        {
+            ordered_conveyor<int, int, jstd::spsc_queue<int> >([](int&& value) { return value; }, [](int&&) {},
+                                                              options);
+        };
+
+    EXPECT_THROW(createConveyor(), std::invalid_argument);
+    }
+
+    TEST(UnitTest_ordered_conveyor, multipleProducers)
+    {
+        const auto producerCount = 4;
+        const auto count = 1000;
+
+        auto&& results = std::vector<std::pair<int, int> >();
+        auto&& options = jstd::conveyor_options();
+        options.threads = 4;
+
+        {
+            auto&& testConveyor = ordered_conveyor<std::pair<int, int>, std::pair<int, int> >(
+                    [](std::pair<int, int>&& value) { return value; },
+                    [&](std::pair<int, int>&& value) { results.push_back(value); },
+                    options);
+
+            auto&& producers = std::vector<std::future<void> >();
+
+            for (auto producer = 0; producer < producerCount; ++producer)
+                producers.push_back(std::async(std::launch::async, [&testConveyor, producer, count]
+                {
+                    for (auto i = 0; i < count; ++i)
+                        testConveyor.push(std::make_pair(producer, i));
+                }));
+
+            for (auto& producer : producers)
+                producer.wait();
+        }
+
+        auto&& next = std::vector<int>(producerCount, 0);
+
+        for (const auto& value : results)
+    ASSERT_EQ(next[value.first]++, value.second);
+
+    EXPECT_THAT(next, testing::Each(count));
+    }
+
+    TEST(UnitTest_ordered_conveyor, processorThrows)
+    {
+        auto&& results = std::vector<int>();
+        auto&& options = jstd::conveyor_options();
+        options.threads = 4;
+        options.capacity = 4;
+
+        {
+            auto&& testConveyor = ordered_conveyor<int, int>(
+                    [](int&& value)
+                    {
+                        if (value == 10)
+                            throw std::runtime_error("TestError");
+
+                        return value;
+                    },
+                    [&](int&& value) { results.push_back(value); },
+                    options);
+
+            // Values after the error are rejected instead of blocking the producer.
+            for (auto i = 0; i < 1000; ++i)
+                testConveyor.push(int(i));
+        }
+
+    ASSERT_GE(10, results.size());
+
+        for (auto i = 0u; i < results.size(); ++i)
+    ASSERT_EQ(i, results[i]);
+    }
+
+    TEST(UnitTest_ordered_conveyor, sinkThrows)
+    {
+        auto&& delivered = 0;
+        auto&& options = jstd::conveyor_options();
+        options.threads = 2;
+
+        {
+            auto&& testConveyor = ordered_conveyor<int, int>(
+                    [](int&& value) { return value; },
+                    [&](int&&)
+                    {
+                        if (++delivered == 5)
+                            throw std::runtime_error("TestError");
+                    },
+                    options);
+
+            for (auto i = 0; i < 100; ++i)
+                testConveyor.push(int(i));
+        }
+
+    EXPECT_EQ(5, delivered);
+    }
+
+    TEST(UnitTest_ordered_conveyor, executor)
+    {
+        auto&& pool = jstd::thread_pool();
+        auto&& results = std::vector<int>();
+        auto&& options = jstd::conveyor_options();
+        options.threads = 2;
+        options.executor = &pool;
+
+        {
+            auto&& testConveyor = ordered_conveyor<int, int>([](int&& value) { return value; },
+                                                            [&](int&& value) { results.push_back(value); },
+                                                            options);
+
+            testConveyor.push(1);
+            testConveyor.push(2);
+        }
+
+    EXPECT_THAT(results, ElementsAre(1, 2));
+    EXPECT_EQ(2, pool.size());
+    }
+}
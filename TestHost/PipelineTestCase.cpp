@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <concurrency/pipeline.h>
+#include <concurrency/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    class PipelineException : public std::runtime_error
+    {
+    public:
+        PipelineException() : std::runtime_error("pipeline") {}
+    };
+
+    void produce(jstd::conveyor_forwarder<int>& forwarder, int count)
+    {
+        for (auto i = 0; i < count; ++i)
+            forwarder.push(int(i));
+    }
+
+    TEST(UnitTest_pipeline, consumer)
+    {
+        auto results = std::vector<int>();
+
+        auto&& testPipeline = jstd::make_pipeline([&](int&& value) { results.push_back(value); });
+        testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, 3); });
+
+    EXPECT_THAT(results, ElementsAre(0, 1, 2));
+    }
+
+    TEST(UnitTest_pipeline, runMultipleTimes)
+    {
+        auto results = std::vector<std::string>();
+
+        auto converter = [](int&& value, jstd::conveyor_forwarder<std::string>& forwarder)
+        {
+            forwarder.push(std::string(std::size_t(value), 'A'));
+        };
+
+        auto&& testPipeline = jstd::make_pipeline(converter, [&](std::string&& value) { results.push_back(value); });
+
+        for (auto count = 1; count <= 3; ++count)
+        {
+            results.clear();
+            testPipeline->run([count](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, count); });
+
+            // Every run returns only after all its values reached the consumer.
+        EXPECT_EQ(std::size_t(count), results.size());
+        }
+
+    EXPECT_THAT(results, ElementsAre(""s, "A"s, "AA"s));
+    }
+
+    TEST(UnitTest_pipeline, reusesThreads)
+    {
+        auto threads = std::set<std::thread::id>();
+
+        auto&& testPipeline = jstd::make_pipeline([&](int&&) { threads.insert(std::this_thread::get_id()); });
+
+        for (auto i = 0; i < 10; ++i)
+            testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, 5); });
+
+    EXPECT_EQ(1u, threads.size());
+    }
+
+    TEST(UnitTest_pipeline, multipleConverters)
+    {
+        auto sum = 0;
+
+        auto&& testPipeline = jstd::make_pipeline(
+                [](int&& value, jstd::conveyor_forwarder<int>& forwarder) { forwarder.push(value * 2); },
+                [](int&& value, jstd::conveyor_forwarder<int>& forwarder)
+                {
+                    // Converters may forward any number of values.
+                    forwarder.push(int(value));
+                    forwarder.push(int(value));
+                },
+                [&](int&& value) { sum += value; });
+
+        testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, 10); });
+
+    EXPECT_EQ(180, sum);
+    }
+
+    TEST(UnitTest_pipeline, parallelStage)
+    {
+        auto results = std::vector<int>();
+
+        auto converter = [](int&& value, jstd::conveyor_forwarder<int>& forwarder) { forwarder.push(+value); };
+
+        auto&& testPipeline = jstd::make_pipeline(jstd::parallel(4, converter),
+                                                  [&](int&& value) { results.push_back(value); });
+
+        for (auto i = 0; i < 5; ++i)
+        {
+            results.clear();
+            testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, 100); });
+
+        EXPECT_EQ(100u, results.size());
+        }
+
+        std::sort(results.begin(), results.end());
+    EXPECT_EQ(0, results.front());
+    EXPECT_EQ(99, results.back());
+    }
+
+    TEST(UnitTest_pipeline, pushAndFlush)
+    {
+        std::atomic<int> sum { 0 };
+
+        auto&& testPipeline = jstd::make_pipeline([&](int&& value) { sum += value; });
+
+        for (auto i = 1; i <= 100; ++i)
+            testPipeline->push(int(i));
+
+        testPipeline->flush();
+
+    EXPECT_EQ(5050, sum);
+    }
+
+    TEST(UnitTest_pipeline, consumerThrows)
+    {
+        auto results = std::vector<int>();
+
+        auto&& testPipeline = jstd::make_pipeline([&](int&& value)
+                                                  {
+                                                      if (value == 1)
+                                                          throw PipelineException();
+
+                                                      results.push_back(value);
+                                                  });
+
+    EXPECT_THROW(testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, 3); }),
+                 PipelineException);
+    EXPECT_THAT(results, ElementsAre(0, 2));
+
+        // The error is reported once and the pipeline keeps running.
+        results.clear();
+        testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { forwarder.push(5); });
+
+    EXPECT_THAT(results, ElementsAre(5));
+    }
+
+    TEST(UnitTest_pipeline, producerThrows)
+    {
+        auto results = std::vector<int>();
+
+        auto&& testPipeline = jstd::make_pipeline([&](int&& value) { results.push_back(value); });
+
+    EXPECT_THROW(testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder)
+                                   {
+                                       produce(forwarder, 2);
+                                       throw PipelineException();
+                                   }), PipelineException);
+    EXPECT_THAT(results, ElementsAre(0, 1));
+    }
+
+    TEST(UnitTest_pipeline, producerThrowsKeepsStageError)
+    {
+        auto&& testPipeline = jstd::make_pipeline([](int&& value)
+                                                  {
+                                                      if (value == 1)
+                                                          throw std::runtime_error("TestError");
+                                                  });
+
+        testPipeline->push(1);
+
+        // The stage error may belong to the push, so it is not dropped along with the producer exception.
+    EXPECT_THROW(testPipeline->run([](jstd::conveyor_forwarder<int>&) { throw PipelineException(); }),
+                 PipelineException);
+    EXPECT_THROW(testPipeline->flush(), std::runtime_error);
+    EXPECT_NO_THROW(testPipeline->flush());
+    }
+
+    TEST(UnitTest_pipeline, executor)
+    {
+        auto&& pool = jstd::thread_pool();
+        auto results = std::vector<std::string>();
+
+        {
+            auto&& testPipeline = jstd::make_pipeline(
+                    pool,
+                    [](int&& value, jstd::conveyor_forwarder<std::string>& forwarder)
+                    {
+                        forwarder.push(std::to_string(value));
+                    },
+                    [&](std::string&& value) { results.push_back(value); });
+
+            testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, 2); });
+            testPipeline->run([](jstd::conveyor_forwarder<int>& forwarder) { produce(forwarder, 1); });
+        }
+
+    EXPECT_THAT(results, ElementsAre("0"s, "1"s, "0"s));
+    EXPECT_EQ(2u, pool.size());
+    }
+
+    TEST(UnitTest_pipeline, closeProcessesQueuedValues)
+    {
+        auto sum = 0;
+
+        auto&& testPipeline = jstd::make_pipeline([&](int&& value) { sum += value; });
+
+        testPipeline->push(1);
+        testPipeline->push(2);
+        testPipeline->close();
+
+        // Values pushed after closing are discarded.
+        testPipeline->push(4);
+        testPipeline->flush();
+
+    EXPECT_EQ(3, sum);
+    }
+
+    TEST(UnitTest_pipeline, staticForwarder)
+    {
+        auto results = std::vector<std::string>();
+
+        auto converter = [](int&& value, jstd::static_forwarder<std::string>& forwarder)
+        {
+            forwarder.push(std::to_string(value));
+        };
+
+        auto&& testPipeline = jstd::make_pipeline(converter, [&](std::string&& value) { results.push_back(value); });
+
+        testPipeline->run([](jstd::static_forwarder<int>& forwarder) { forwarder.push(7); });
+
+    EXPECT_THAT(results, ElementsAre("7"s));
+    }
+
+    TEST(UnitTest_pipeline, capacity)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 1;
+
+        auto sum = 0;
+        auto&& testPipeline = jstd::make_pipeline(options, [&](int&& value) { sum += value; });
+
+        for (auto run = 0; run < 3; ++run)
+        {
+            testPipeline->run([](jstd::static_forwarder<int>& forwarder)
+                              {
+                                  for (auto i = 1; i <= 100; ++i)
+                                      forwarder.push(std::move(i));
+                              });
+        }
+
+    EXPECT_EQ(3 * 5050, sum);
+    }
+}
@@ -0,0 +1,271 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <future>
+#include <set>
+
+#include <concurrency/priority_conveyor.h>
+
+using jstd::priority_conveyor;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    template <typename T>
+    class UnitTest_priority_conveyor : public testing::Test
+    {
+    };
+
+    using PriorityStorageTypes = ::testing::Types<
+            jstd::priority_lanes<4>,
+            jstd::priority_heap<>,
+            jstd::priority_heap<2> >;
+
+    TYPED_TEST_CASE(UnitTest_priority_conveyor, PriorityStorageTypes);
+
+    // Blocks the processor with a first value, so that all further values are pending at once.
+    template <typename Storage>
+    class BlockedConveyor
+    {
+    public:
+        explicit BlockedConveyor(std::vector<std::string>& results,
+                                 const jstd::conveyor_options& options = jstd::conveyor_options())
+            : released_(release_.get_future().share())
+            , conveyor_([this, &results](std::string&& value)
+                        {
+                            if (results.empty())
+                            {
+                                started_.set_value();
+                                released_.wait();
+                            }
+
+                            results.push_back(std::move(value));
+                        },
+                        options)
+        {
+            conveyor_.push(0, "first"s);
+            started_.get_future().wait();
+        }
+
+        priority_conveyor<std::string, Storage>& get()
+        {
+            return conveyor_;
+        }
+
+        void release()
+        {
+            release_.set_value();
+        }
+
+    private:
+        std::promise<void> started_;
+        std::promise<void> release_;
+        std::shared_future<void> released_;
+        priority_conveyor<std::string, Storage> conveyor_;
+    };
+
+    TYPED_TEST(UnitTest_priority_conveyor, pushAndWait)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor = priority_conveyor<std::string, TypeParam>(
+                    [&](std::string&& value) { results.push_back(std::move(value)); });
+
+            const auto value2 = "value2"s;
+
+            testConveyor.push(1, "value1"s);
+            testConveyor.push(1, value2);
+            testConveyor.emplace(1, "value3");
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s));
+    }
+
+    TYPED_TEST(UnitTest_priority_conveyor, higherPriorityFirst)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& blocked = BlockedConveyor<TypeParam>(results);
+            auto& testConveyor = blocked.get();
+
+            testConveyor.push(3, "bulk1"s);
+            testConveyor.push(2, "normal1"s);
+            testConveyor.push(3, "bulk2"s);
+            testConveyor.push(0, "urgent1"s);
+            testConveyor.push(2, "normal2"s);
+            testConveyor.push(0, "urgent2"s);
+            testConveyor.push(3, "bulk3"s);
+            testConveyor.push(1, "high1"s);
+
+            blocked.release();
+        }
+
+    EXPECT_THAT(results, ElementsAre("first"s, "urgent1"s, "urgent2"s, "high1"s, "normal1"s, "normal2"s,
+                                     "bulk1"s, "bulk2"s, "bulk3"s));
+    }
+
+    TYPED_TEST(UnitTest_priority_conveyor, starvationLimit)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.starvation_limit = 2;
+
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& blocked = BlockedConveyor<TypeParam>(results, options);
+            auto& testConveyor = blocked.get();
+
+            testConveyor.push(3, "bulk1"s);
+            testConveyor.push(3, "bulk2"s);
+
+            for (auto i = 1; i <= 6; ++i)
+                testConveyor.push(0, "urgent" + std::to_string(i));
+
+            blocked.release();
+        }
+
+        // The first value counts as processed by priority.
+    EXPECT_THAT(results, ElementsAre("first"s, "urgent1"s, "bulk1"s, "urgent2"s, "urgent3"s, "bulk2"s,
+                                     "urgent4"s, "urgent5"s, "urgent6"s));
+    }
+
+    TYPED_TEST(UnitTest_priority_conveyor, capacity)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 2;
+
+        auto&& results = std::vector<std::string>();
+        auto&& blocked = BlockedConveyor<TypeParam>(results, options);
+        auto& testConveyor = blocked.get();
+
+        auto&& value = "value3"s;
+
+    EXPECT_TRUE(testConveyor.try_push(1, "value1"s));
+    EXPECT_TRUE(testConveyor.try_push(1, "value2"s));
+    EXPECT_FALSE(testConveyor.try_push(0, std::move(value)));
+    EXPECT_EQ("value3"s, value);
+    EXPECT_FALSE(testConveyor.push_for(0, value, std::chrono::milliseconds(1)));
+
+        blocked.release();
+
+    EXPECT_TRUE(testConveyor.push_for(0, value, std::chrono::seconds(10)));
+    }
+
+    TYPED_TEST(UnitTest_priority_conveyor, manyValues)
+    {
+        auto&& results = std::vector<std::pair<std::size_t, int> >();
+
+        auto&& options = jstd::conveyor_options();
+        options.starvation_limit = 3;
+
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+
+        {
+            auto&& testConveyor = priority_conveyor<std::pair<std::size_t, int>, TypeParam>(
+                    [&](std::pair<std::size_t, int>&& value)
+                    {
+                        released.wait();
+                        results.push_back(value);
+                    },
+                    options);
+
+            for (auto i = 0; i < 1000; ++i)
+                testConveyor.push(std::size_t(i * 7 % 4), std::make_pair(std::size_t(i * 7 % 4), i));
+
+            release.set_value();
+        }
+
+    ASSERT_EQ(1000, results.size());
+
+        // Values of the same priority keep their order.
+        auto&& last = std::vector<int>(4, -1);
+
+        for (const auto& value : results)
+        {
+    ASSERT_LT(last[value.first], value.second);
+            last[value.first] = value.second;
+        }
+    }
+
+    TYPED_TEST(UnitTest_priority_conveyor, storageTakesOldest)
+    {
+        auto&& storage = typename TypeParam::template storage<int>();
+
+        // Pending values by priority and sequence, the reference for the storage.
+        auto&& expected = std::set<std::pair<std::size_t, std::size_t> >();
+        auto&& sequence = std::size_t(0);
+
+        for (auto round = 0; round < 200; ++round)
+        {
+            for (auto i = 0; i < 3; ++i)
+            {
+                const auto priority = std::size_t((round * 5 + i * 3) % 4);
+
+                storage.push(priority, sequence, int(sequence));
+                expected.emplace(priority, sequence++);
+            }
+
+            for (auto i = 0; i < (round % 3 == 0 ? 1 : 2); ++i)
+            {
+                const auto oldest = i == 0 && round % 2 == 0;
+                const auto next = oldest
+                                  ? *std::min_element(expected.begin(), expected.end(),
+                                                      [](const std::pair<std::size_t, std::size_t>& first,
+                                                         const std::pair<std::size_t, std::size_t>& second)
+                                                      {
+                                                          return first.second < second.second;
+                                                      })
+                                  : *expected.begin();
+
+                const auto value = storage.take(oldest);
+                expected.erase(next);
+
+    ASSERT_EQ(next.second, value.sequence);
+    ASSERT_EQ(int(next.second), value.value);
+            }
+        }
+
+    EXPECT_EQ(expected.size(), storage.size());
+    }
+
+    TEST(UnitTest_priority_conveyor, priorityExceedsLanes)
+    {
+        auto&& testConveyor = priority_conveyor<int, jstd::priority_lanes<2> >([](int&&) {});
+
+    EXPECT_THROW(testConveyor.push(2, 0), std::out_of_range);
+    }
+
+    TEST(UnitTest_priority_conveyor, heapAcceptsArbitraryPriorities)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& blocked = BlockedConveyor<jstd::priority_heap<> >(results);
+            auto& testConveyor = blocked.get();
+
+            for (auto priority : { 1000u, 5u, 70000u, 0u, 42u })
+                testConveyor.push(priority, std::to_string(priority));
+
+            blocked.release();
+        }
+
+    EXPECT_THAT(results, ElementsAre("first"s, "0"s, "5"s, "42"s, "1000"s, "70000"s));
+    }
+
+    TEST(UnitTest_priority_conveyor, processorThrows)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.capacity = 1;
+
+        auto&& testConveyor = priority_conveyor<int>([](int&&) { throw std::runtime_error("TestError"); }, options);
+
+        // A producer does not wait for a conveyor, that stopped processing.
+        for (auto i = 0; i < 100; ++i)
+            testConveyor.push(0, int(i));
+    }
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <concurrency/recycler.h>
+#include <concurrency/conveyor.h>
+#include <concurrency/batch_conveyor.h>
+
+using jstd::recycler;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    // The tests flush the conveyors, so that the processed values are back in the recycler.
+    using string_conveyor = jstd::conveyor<std::string,
+                                           jstd::blocking_queue<std::string>,
+                                           std::function<void(std::string&&)>,
+                                           jstd::no_statistics,
+                                           jstd::conveyor_flush>;
+
+    using vector_batch_conveyor = jstd::batch_conveyor<std::vector<int>,
+                                                       jstd::blocking_queue<std::vector<int> >,
+                                                       jstd::no_statistics,
+                                                       jstd::conveyor_flush>;
+
+    TEST(UnitTest_recycler, acquireFromEmpty)
+    {
+        auto&& testRecycler = recycler<std::string>(4);
+
+    EXPECT_EQ(""s, testRecycler.acquire());
+    }
+
+    TEST(UnitTest_recycler, reusesReleasedObjects)
+    {
+        auto&& testRecycler = recycler<std::vector<int> >(4);
+
+        auto&& value = std::vector<int>(1000);
+        const auto data = value.data();
+
+        testRecycler.release(std::move(value));
+
+        const auto reused = testRecycler.acquire();
+    EXPECT_EQ(data, reused.data());
+    EXPECT_TRUE(testRecycler.acquire().empty());
+    }
+
+    TEST(UnitTest_recycler, dropsObjectsWhenFull)
+    {
+        auto&& testRecycler = recycler<std::string>(2);
+
+        testRecycler.release("value1"s);
+        testRecycler.release("value2"s);
+        testRecycler.release("value3"s);
+
+    EXPECT_EQ("value1"s, testRecycler.acquire());
+    EXPECT_EQ("value2"s, testRecycler.acquire());
+    EXPECT_EQ(""s, testRecycler.acquire());
+    }
+
+    TEST(UnitTest_recycler, multipleThreads)
+    {
+        auto&& testRecycler = recycler<std::unique_ptr<int> >(64);
+        auto&& threads = std::vector<std::future<int> >();
+
+        for (auto thread = 0; thread < 4; ++thread)
+            threads.push_back(std::async(std::launch::async, [&]
+            {
+                auto allocations = 0;
+
+                for (auto i = 0; i < 1000; ++i)
+                {
+                    auto&& value = testRecycler.acquire();
+
+                    if (!value)
+                    {
+                        value = std::make_unique<int>(0);
+                        ++allocations;
+                    }
+
+                    ++*value;
+                    testRecycler.release(std::move(value));
+                }
+
+                return allocations;
+            }));
+
+        auto allocations = 0;
+
+        for (auto& thread : threads)
+            allocations += thread.get();
+
+        auto sum = 0;
+
+        for (auto value = testRecycler.acquire(); value; value = testRecycler.acquire())
+            sum += *value;
+
+        // Objects are only allocated, while all others are in use by the other threads.
+    EXPECT_LE(allocations, 4);
+    EXPECT_EQ(4000, sum);
+    }
+
+    TEST(UnitTest_recycler, conveyorRecyclesProcessedValues)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.recycle_capacity = 4;
+
+        auto&& buffers = std::vector<const char*>();
+        auto&& reused = 0;
+
+        {
+            auto&& testConveyor = string_conveyor([&](std::string&& value)
+                                                  {
+                                                      if (std::find(buffers.begin(), buffers.end(),
+                                                                    value.data()) != buffers.end())
+                                                          ++reused;
+                                                      else
+                                                          buffers.push_back(value.data());
+                                                  },
+                                                  options);
+
+            for (auto i = 0; i < 100; ++i)
+            {
+                auto&& value = testConveyor.acquire();
+                value.assign(100, 'a');
+
+                testConveyor.push(std::move(value));
+                testConveyor.flush();
+            }
+        }
+
+    EXPECT_EQ(99, reused);
+    }
+
+    TEST(UnitTest_recycler, conveyorWithoutRecycling)
+    {
+        auto&& testConveyor = string_conveyor([](std::string&&) {});
+
+        testConveyor.push(std::string(100, 'a'));
+        testConveyor.flush();
+
+    EXPECT_EQ(""s, testConveyor.acquire());
+    }
+
+    TEST(UnitTest_recycler, batchConveyorRecyclesProcessedValues)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.recycle_capacity = 4;
+
+        auto&& testConveyor = vector_batch_conveyor([](std::vector<std::vector<int> >&&) {}, options);
+
+        auto&& value = std::vector<int>(1000);
+        const auto data = value.data();
+
+        testConveyor.push(std::move(value));
+        testConveyor.flush();
+
+    EXPECT_EQ(data, testConveyor.acquire().data());
+    }
+}
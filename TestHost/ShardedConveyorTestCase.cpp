@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <concurrency/sharded_conveyor.h>
+
+using jstd::sharded_conveyor;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    using Event = std::pair<int, int>;
+
+    int accountOf(const Event& event)
+    {
+        return event.first;
+    }
+
+    TEST(UnitTest_sharded_conveyor, pushAndWait)
+    {
+        auto&& results = std::vector<std::string>();
+
+        {
+            auto&& testConveyor = sharded_conveyor<std::string, std::size_t>(
+                    [](const std::string& value) { return value.size(); },
+                    [&](std::string&& value) { results.push_back(std::move(value)); });
+
+            const auto value3 = "value3"s;
+
+            testConveyor.push("value1"s);
+            testConveyor.push("value2"s);
+            testConveyor.push(value3);
+
+        EXPECT_TRUE(testConveyor.try_push("value4"s));
+        EXPECT_TRUE(testConveyor.push_for("value5"s, std::chrono::seconds(1)));
+        EXPECT_EQ(1, testConveyor.lanes());
+        }
+
+    EXPECT_THAT(results, ElementsAre("value1"s, "value2"s, "value3"s, "value4"s, "value5"s));
+    }
+
+    TEST(UnitTest_sharded_conveyor, keepsOrderPerKey)
+    {
+        const auto accounts = 16;
+        const auto count = 500;
+
+        auto&& guard = std::mutex();
+        auto&& results = std::map<int, std::vector<int> >();
+        auto&& options = jstd::conveyor_options();
+        options.threads = 4;
+
+        {
+            auto&& testConveyor = sharded_conveyor<Event, int>(
+                    accountOf,
+                    [&](Event&& event)
+                    {
+                        if (event.second % 11 == 0)
+                            std::this_thread::yield();
+
+                        std::lock_guard<std::mutex> lock(guard);
+                        results[event.first].push_back(event.second);
+                    },
+                    options);
+
+        EXPECT_EQ(4, testConveyor.lanes());
+
+            for (auto i = 0; i < count; ++i)
+            {
+                for (auto account = 0; account < accounts; ++account)
+                    testConveyor.push(Event(account, i));
+            }
+        }
+
+    ASSERT_EQ(accounts, results.size());
+
+        for (const auto& account : results)
+        {
+    ASSERT_EQ(count, account.second.size());
+
+            for (auto i = 0; i < count; ++i)
+    ASSERT_EQ(i, account.second[i]);
+        }
+    }
+
+    TEST(UnitTest_sharded_conveyor, differentLanesRunInParallel)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.threads = 4;
+
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+        auto&& processed = std::promise<int>();
+
+        auto&& testConveyor = sharded_conveyor<Event, int>(
+                accountOf,
+                [&](Event&& event)
+                {
+                    if (event.second == 0)
+                        released.wait();
+                    else
+                        processed.set_value(event.first);
+                },
+                options);
+
+        auto other = 1;
+
+        while (testConveyor.lane(other) == testConveyor.lane(0))
+            ++other;
+
+        testConveyor.push(Event(0, 0));
+        testConveyor.push(Event(other, 1));
+
+    EXPECT_EQ(other, processed.get_future().get());
+
+        release.set_value();
+    }
+
+    TEST(UnitTest_sharded_conveyor, lanesAreSpread)
+    {
+        auto&& options = jstd::conveyor_options();
+        options.threads = 8;
+
+        auto&& testConveyor = sharded_conveyor<int, int>([](const int& value) { return value; }, [](int&&) {}, options);
+
+        auto&& counts = std::vector<int>(testConveyor.lanes(), 0);
+
+        for (auto key = 0; key < 8000; ++key)
+            ++counts[testConveyor.lane(key)];
+
+        for (const auto count : counts)
+        {
+    EXPECT_LT(800, count);
+    EXPECT_GT(1200, count);
+        }
+    }
+}
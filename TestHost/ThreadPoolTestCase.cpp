@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <concurrency/thread_pool.h>
+#include <concurrency/conveyor.h>
+#include <concurrency/conveyor_function.h>
+
+using jstd::thread_pool;
+using testing::ElementsAre;
+using namespace std::literals::string_literals;
+
+namespace
+{
+    TEST(UnitTest_thread_pool, execute)
+    {
+        auto&& pool = thread_pool();
+        auto&& promise = std::promise<std::thread::id>();
+
+        pool.execute([&] { promise.set_value(std::this_thread::get_id()); });
+
+    EXPECT_NE(std::this_thread::get_id(), promise.get_future().get());
+    EXPECT_EQ(1, pool.size());
+    }
+
+    TEST(UnitTest_thread_pool, reusesIdleThreads)
+    {
+        auto&& pool = thread_pool(1);
+
+        for (auto i = 0; i < 10; ++i)
+        {
+            auto&& promise = std::promise<void>();
+            pool.execute([&] { promise.set_value(); });
+            promise.get_future().wait();
+
+            // The thread has to become idle again before it can be reused.
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+    EXPECT_EQ(1, pool.size());
+    }
+
+    TEST(UnitTest_thread_pool, startsThreadsForBusyTasks)
+    {
+        auto&& pool = thread_pool();
+        auto&& release = std::promise<void>();
+        auto&& released = release.get_future().share();
+        auto&& finished = std::atomic_int(0);
+
+        for (auto i = 0; i < 4; ++i)
+            pool.execute([&]
+                         {
+                             released.wait();
+                             ++finished;
+                         });
+
+    EXPECT_EQ(4, pool.size());
+
+        release.set_value();
+    }
+
+    TEST(UnitTest_thread_pool, finishesTasksOnDestruction)
+    {
+        auto&& finished = std::atomic_int(0);
+
+        {
+            auto&& pool = thread_pool();
+
+            for (auto i = 0; i < 4; ++i)
+                pool.execute([&]
+                             {
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                                 ++finished;
+                             });
+        }
+
+    EXPECT_EQ(4, finished);
+    }
+
+    TEST(UnitTest_thread_pool, conveyor)
+    {
+        auto&& pool = thread_pool(1);
+        auto&& options = jstd::conveyor_options();
+        options.executor = &pool;
+
+        auto&& results = std::vector<std::string>();
+
+        for (auto i = 0; i < 10; ++i)
+        {
+            auto&& testConveyor =
+                    jstd::conveyor<std::string>([&](std::string&& value) { results.push_back(std::move(value)); },
+                                                options);
+
+            testConveyor.push(std::to_string(i));
+        }
+
+    EXPECT_THAT(results, ElementsAre("0"s, "1"s, "2"s, "3"s, "4"s, "5"s, "6"s, "7"s, "8"s, "9"s));
+    EXPECT_GE(2, pool.size());
+    }
+
+    TEST(UnitTest_thread_pool, conveyor_function)
+    {
+        auto&& pool = thread_pool();
+        auto&& results = std::vector<std::string>();
+
+        for (auto i = 0; i < 3; ++i)
+        {
+            jstd::conveyor_function(pool,
+                                    [&](jstd::conveyor_forwarder<int>& forwarder)
+                                    {
+                                        forwarder.push(i);
+                                    },
+                                    [](int&& value, jstd::conveyor_forwarder<std::string>& forwarder)
+                                    {
+                                        forwarder.push(std::to_string(value));
+                                    },
+                                    [&](std::string&& value)
+                                    {
+                                        results.push_back(std::move(value));
+                                    });
+        }
+
+    EXPECT_THAT(results, ElementsAre("0"s, "1"s, "2"s));
+    }
+
+    TEST(UnitTest_thread_pool, conveyor_function_consumerThrows)
+    {
+        auto&& pool = thread_pool();
+
+        auto producer = [](jstd::conveyor_forwarder<int>& forwarder)
+        {
+            for (auto i = 0; i < 100; ++i)
+                forwarder.push(int(i));
+        };
+
+        auto consumer = [](int&&)
+        {
+            throw std::runtime_error("TestError");
+        };
+
+    EXPECT_THROW(jstd::conveyor_function(pool, producer, consumer), std::runtime_error);
+    }
+}
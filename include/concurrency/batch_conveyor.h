@@ -0,0 +1,168 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <future>
+#include <functional>
+#include <vector>
+
+#include "internal/conveyor_queue.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Passes pushed values in batches to a processor function that runs on a separated thread.
+     *
+     * Whenever the processor thread wakes up, it takes all values that are queued at that time and passes them
+     * with a single call to the processor. Under load this amortizes the synchronization with the producers over
+     * many values, which suits processors like bulk database writers that are cheaper per value in batches.
+     *
+     * The batch_size and batch_delay options bound the batches: a batch is passed once it is full or once the
+     * delay after its first value has expired, whichever comes first. The delay is measured from the moment the
+     * processor takes that value, not from its push.
+     *
+     * @tparam ForwardType Type of the pushed values.
+     * @tparam Queue Type of the queue that transfers the values to the processor thread.
+     * @tparam Statistics Either no_statistics (default) or conveyor_statistics, which enables stats().
+     * @tparam Flush Either no_flush (default) or conveyor_flush, which enables flush() and flush_async().
+     */
+    template <typename ForwardType,
+              typename Queue = blocking_queue<ForwardType>,
+              typename Statistics = no_statistics,
+              typename Flush = no_flush>
+    class batch_conveyor : public internal::conveyor_queue<ForwardType, Queue, Statistics, Flush>
+    {
+        using base_type = internal::conveyor_queue<ForwardType, Queue, Statistics, Flush>;
+        using typename base_type::stored_type;
+        using base_type::queue_;
+        using base_type::statistics_;
+        using base_type::barrier_;
+
+    public:
+        using BatchType = std::vector<ForwardType>;
+        using ProcessorFunction = std::function<void(BatchType&&)>;
+
+    public:
+        explicit batch_conveyor(const ProcessorFunction& processor,
+                                const conveyor_options& options = conveyor_options())
+            : base_type(options, 1)
+            , processor_(processor)
+            , batchSize_(options.batch_size)
+            , batchDelay_(options.batch_delay)
+            , processorHandle_(internal::launch(options, [this] { run(); }))
+        {
+        }
+
+        explicit batch_conveyor(ProcessorFunction&& processor,
+                                const conveyor_options& options = conveyor_options())
+            : base_type(options, 1)
+            , processor_(std::move(processor))
+            , batchSize_(options.batch_size)
+            , batchDelay_(options.batch_delay)
+            , processorHandle_(internal::launch(options, [this] { run(); }))
+        {
+        }
+
+        ~batch_conveyor()
+        {
+            queue_.close();
+
+            processorHandle_.wait();
+        }
+
+    private:
+
+        void run()
+        {
+            using clock = std::chrono::steady_clock;
+
+            // The batch keeps its capacity between the calls, unless the processor moves it away.
+            auto&& batch = BatchType();
+            auto deadline = clock::time_point();
+
+            try
+            {
+                const auto flush = [this, &batch]
+                {
+                    const auto count = batch.size();
+                    const auto started = Statistics::now();
+
+                    processor_(std::move(batch));
+
+                    // Values are only left for recycling, if the processor did not move the batch away.
+                    for (auto& value : batch)
+                        this->recycle(value);
+
+                    batch.clear();
+
+                    statistics_.processed(0, count, started);
+                    barrier_.processed(0, count);
+                };
+
+                const auto take = [this, &batch, &deadline, &flush](stored_type&& value)
+                {
+                    if (batch.empty() && batchDelay_ != batchDelay_.zero())
+                        deadline = clock::now() + batchDelay_;
+
+                    batch.push_back(statistics_.take(0, value, Statistics::now()));
+
+                    if (batch.size() == batchSize_)
+                        flush();
+                };
+
+                while ((batch.empty() || batchDelay_ == batchDelay_.zero()) ? queue_.pop_all(take)
+                                                                          : queue_.pop_all_until(take, deadline))
+                {
+                    if (!batch.empty() && (batchDelay_ == batchDelay_.zero() || clock::now() >= deadline))
+                        flush();
+                }
+
+                // The values that are still waiting for the delay are passed, when the conveyor is destroyed.
+                if (!batch.empty())
+                    flush();
+            }
+            catch (...)
+            {
+                // Producers must not wait for a full queue, that is not consumed anymore.
+                queue_.close();
+                barrier_.stop();
+                throw;
+            }
+        }
+
+    private:
+        ProcessorFunction processor_;
+        const std::size_t batchSize_;
+        const std::chrono::microseconds batchDelay_;
+        std::future<void> processorHandle_;
+    };
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,282 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <mutex>
+#include <condition_variable>
+
+#include "internal/chunked_queue.h"
+#include "internal/deadline.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Queue that is guarded by a mutex and wakes up waiting threads by condition variables.
+     *
+     * This is the default queue of conveyor. It can be used by any number of producer and consumer threads.
+     * The values are stored in chunks of a page, that the queue keeps for reuse, so that it does not allocate once
+     * it has reached its usual size.
+     *
+     * @tparam T Type of the queued values.
+     */
+    template <typename T>
+    class blocking_queue
+    {
+    public:
+        using value_type = T;
+
+        static const bool multi_consumer = true;
+        static const bool numa_placement = false;
+
+    public:
+        /**
+         * @param capacity Maximum number of queued values. Zero means the queue is unbounded.
+         * Values that have been swapped out by pop_all do not count.
+         */
+        explicit blocking_queue(std::size_t capacity = 0)
+            : capacity_(capacity)
+            , queue_(chunks_)
+            , batch_(chunks_)
+        {
+        }
+
+        blocking_queue(const blocking_queue&) = delete;
+        blocking_queue& operator=(const blocking_queue&) = delete;
+
+        std::size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool push(U&& value)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Constructs a value in place at the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not constructed.
+         */
+        template <typename... Args>
+        bool emplace(Args&&... args)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue, if the queue is not full.
+         * @return false, if the queue is full or has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool try_push(U&& value)
+        {
+            return pushInternal(internal::no_wait(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits until the deadline for free space,
+         * if the queue is full.
+         * @return false, if the deadline expired or the queue has been closed and the value was not queued.
+         */
+        template <typename U, typename Clock, typename Duration>
+        bool push_until(U&& value, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return pushInternal(deadline, std::forward<U>(value));
+        }
+
+        /**
+         * @brief Waits for the next value and passes it as rvalue reference to the consumer.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop(Consumer&& consumer)
+        {
+            std::unique_lock<std::mutex> lock(guard_);
+
+            if (queue_.empty() && !closed_)
+                notEmpty_.wait(lock, [this] { return !queue_.empty() || closed_; });
+
+            if (queue_.empty())
+                return false;
+
+            auto value = std::move(queue_.front());
+            queue_.pop();
+
+            const auto notifyProducer = waitingProducers_ != 0;
+
+            lock.unlock();
+
+            if (notifyProducer)
+                notFull_.notify_one();
+
+            consumer(std::move(value));
+
+            return true;
+        }
+
+        /**
+         * @brief Waits for the next value and passes all queued values one after another as rvalue references
+         * to the consumer.
+         *
+         * All queued values are swapped out under a single lock, so the consumer is called without holding it.
+         * Only one thread at a time may drain the queue by this method.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop_all(Consumer&& consumer)
+        {
+            return popAllInternal(consumer, internal::no_deadline());
+        }
+
+        /**
+         * @brief Waits until the deadline for the next value and passes all queued values one after another as
+         * rvalue references to the consumer.
+         * @return false, if the queue has been closed and all values have been consumed. true without consuming
+         * any value, if the deadline expired.
+         */
+        template <typename Consumer, typename Clock, typename Duration>
+        bool pop_all_until(Consumer&& consumer, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return popAllInternal(consumer, deadline);
+        }
+
+        /**
+         * @brief Rejects all further values and wakes up all waiting producers and consumers.
+         *
+         * Values that were queued before are still passed to the consumers.
+         */
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                closed_ = true;
+            }
+
+            notEmpty_.notify_all();
+            notFull_.notify_all();
+        }
+
+    private:
+        template <typename Consumer, typename Deadline>
+        bool popAllInternal(Consumer& consumer, const Deadline& deadline)
+        {
+            if (batch_.empty())
+            {
+                std::unique_lock<std::mutex> lock(guard_);
+
+                if (queue_.empty() && !closed_)
+                    internal::wait_until(notEmpty_, lock, deadline, [this] { return !queue_.empty() || closed_; });
+
+                if (queue_.empty())
+                    return !closed_;
+
+                batch_.swap(queue_);
+
+                const auto notifyProducers = waitingProducers_ != 0;
+
+                lock.unlock();
+
+                if (notifyProducers)
+                    notFull_.notify_all();
+            }
+
+            // The values are consumed in place, only this thread accesses the batch.
+            while (!batch_.empty())
+            {
+                try
+                {
+                    consumer(std::move(batch_.front()));
+                }
+                catch (...)
+                {
+                    batch_.pop();
+                    throw;
+                }
+
+                batch_.pop();
+            }
+
+            return true;
+        }
+
+        bool isFull() const
+        {
+            return capacity_ != 0 && queue_.size() >= capacity_;
+        }
+
+        template <typename Deadline, typename... Args>
+        bool pushInternal(const Deadline& deadline, Args&&... args)
+        {
+            std::unique_lock<std::mutex> lock(guard_);
+
+            if (isFull() && !closed_)
+            {
+                ++waitingProducers_;
+                internal::wait_until(notFull_, lock, deadline, [this] { return !isFull() || closed_; });
+                --waitingProducers_;
+            }
+
+            if (closed_ || isFull())
+                return false;
+
+            queue_.emplace(std::forward<Args>(args)...);
+
+            lock.unlock();
+            notEmpty_.notify_one();
+
+            return true;
+        }
+
+    private:
+        const std::size_t capacity_;
+
+        internal::chunk_pool<T> chunks_;
+        internal::chunked_queue<T> queue_;
+        internal::chunked_queue<T> batch_;
+        std::mutex guard_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+
+        std::size_t waitingProducers_ { 0 };
+        bool closed_ { false };
+    };
+
+    template <typename T>
+    const bool blocking_queue<T>::multi_consumer;
+
+    template <typename T>
+    const bool blocking_queue<T>::numa_placement;
+
+    /**@}*/
+
+} // jstd
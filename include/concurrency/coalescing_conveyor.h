@@ -0,0 +1,337 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "../container/flat_hash_map.h"
+#include "conveyor_options.h"
+#include "executor.h"
+#include "internal/deadline.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Passes pushed values to a processor function on a separated thread and merges values with the same
+     * key, that are still waiting for the processor.
+     *
+     * The pending values are kept in the order their keys were first pushed, together with a flat_hash_map from the
+     * key to the pending value. A push with a key that is already pending replaces the pending value or merges
+     * the new value into it. The number of pending values is therefore bounded by the number of distinct keys and
+     * the processor only sees the latest state of a key.
+     *
+     * @code
+     * auto&& quotes = jstd::coalescing_conveyor<quote, std::string>(
+     *         [](const quote& value) { return value.symbol; },
+     *         [&](quote&& value) { publish(value); });
+     * @endcode
+     *
+     * @tparam ForwardType Type of the pushed values.
+     * @tparam Key Type of the key, that decides which values are merged.
+     * @tparam Hash Hash function of the key.
+     */
+    template <typename ForwardType, typename Key, typename Hash = std::hash<Key> >
+    class coalescing_conveyor
+    {
+        static_assert(std::is_move_constructible<ForwardType>::value,
+                      "The template parameter is not move constructable. "
+                      "If this type cannot be made move constructable use std::unique_ptr<T>.");
+
+    public:
+        using KeyFunction = std::function<Key(const ForwardType&)>;
+        using ProcessorFunction = std::function<void(ForwardType&&)>;
+        using MergeFunction = std::function<void(ForwardType& pending, ForwardType&& update)>;
+
+    public:
+        /**
+         * @brief Creates a conveyor that replaces a pending value by a newer value with the same key.
+         */
+        coalescing_conveyor(KeyFunction key,
+                            ProcessorFunction processor,
+                            const conveyor_options& options = conveyor_options())
+            : coalescing_conveyor(std::move(key),
+                                  std::move(processor),
+                                  [](ForwardType& pending, ForwardType&& update) { pending = std::move(update); },
+                                  options)
+        {
+        }
+
+        /**
+         * @param key Returns the key of a value. It is called by the pushing thread without holding a lock.
+         * @param processor Called with the pending values on the processor thread.
+         * @param merge Merges a pushed value into the pending value with the same key. It is called by the pushing
+         * thread while the conveyor is locked, so it blocks all other producers and the processor and should be
+         * cheap. An exception of merge is thrown by the push. The pending value is then left as merge left it and
+         * the conveyor keeps working.
+         * @param options The capacity limits the number of pending keys. A push with a new key waits for free space,
+         * a push that is merged never waits.
+         */
+        coalescing_conveyor(KeyFunction key,
+                            ProcessorFunction processor,
+                            MergeFunction merge,
+                            const conveyor_options& options = conveyor_options())
+            : key_(std::move(key))
+            , processor_(std::move(processor))
+            , merge_(std::move(merge))
+            , capacity_(options.capacity)
+            , processorHandle_(internal::launch(options, [this] { run(); }))
+        {
+        }
+
+        coalescing_conveyor(const coalescing_conveyor&) = delete;
+        coalescing_conveyor& operator=(const coalescing_conveyor&) = delete;
+
+        /**
+         * @brief Waits until all pending values have been processed.
+         */
+        ~coalescing_conveyor()
+        {
+            close();
+
+            processorHandle_.wait();
+        }
+
+        /**
+         * @brief Pushes a value to the processor or merges it into the pending value with the same key.
+         *
+         * Waits for free space, if the key is not pending and the conveyor is full.
+         */
+        void push(ForwardType&& forwardValue)
+        {
+            pushInternal(std::move(forwardValue), internal::no_deadline());
+        }
+
+        template <typename T = ForwardType>
+        void push(const T& forwardValue,
+                  typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            pushInternal(forwardValue, internal::no_deadline());
+        }
+
+        /**
+         * @brief Pushes a value to the processor or merges it into the pending value with the same key, if the
+         * key is pending or the conveyor is not full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        bool try_push(ForwardType&& forwardValue)
+        {
+            return pushInternal(std::move(forwardValue), internal::no_wait());
+        }
+
+        template <typename T = ForwardType>
+        bool try_push(const T& forwardValue,
+                      typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return pushInternal(forwardValue, internal::no_wait());
+        }
+
+        /**
+         * @brief Pushes a value to the processor or merges it into the pending value with the same key and waits
+         * at most for the given duration for free space, if the key is not pending and the conveyor is full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        template <typename Rep, typename Period>
+        bool push_for(ForwardType&& forwardValue, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            return push_until(std::move(forwardValue), std::chrono::steady_clock::now() + timeout);
+        }
+
+        template <typename Rep, typename Period, typename T = ForwardType>
+        bool push_for(const T& forwardValue, const std::chrono::duration<Rep, Period>& timeout,
+                      typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return push_until(forwardValue, std::chrono::steady_clock::now() + timeout);
+        }
+
+        /**
+         * @brief Pushes a value to the processor or merges it into the pending value with the same key and waits
+         * at most until the deadline for free space, if the key is not pending and the conveyor is full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        template <typename Clock, typename Duration>
+        bool push_until(ForwardType&& forwardValue, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return pushInternal(std::move(forwardValue), deadline);
+        }
+
+        template <typename Clock, typename Duration, typename T = ForwardType>
+        bool push_until(const T& forwardValue, const std::chrono::time_point<Clock, Duration>& deadline,
+                        typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return pushInternal(forwardValue, deadline);
+        }
+
+    private:
+        static ForwardType&& forwarded(ForwardType&& value)
+        {
+            return std::move(value);
+        }
+
+        static ForwardType forwarded(const ForwardType& value)
+        {
+            return value;
+        }
+
+        bool isFull() const
+        {
+            return capacity_ != 0 && pending_.size() >= capacity_;
+        }
+
+        template <typename U, typename Deadline>
+        bool pushInternal(U&& value, const Deadline& deadline)
+        {
+            auto&& key = key_(value);
+
+            std::unique_lock<std::mutex> lock(guard_);
+
+            while (!closed_)
+            {
+                const auto pending = indices_.find(key);
+
+                if (pending != indices_.end())
+                {
+                    merge_(pending_[pending->second], forwarded(std::forward<U>(value)));
+                    return true;
+                }
+
+                if (!isFull())
+                {
+                    // The value is added before its index, so a throwing copy or allocation leaves both unchanged.
+                    pending_.push_back(std::forward<U>(value));
+
+                    try
+                    {
+                        indices_.emplace(std::move(key), pending_.size() - 1);
+                    }
+                    catch (...)
+                    {
+                        pending_.pop_back();
+                        throw;
+                    }
+
+                    lock.unlock();
+                    notEmpty_.notify_one();
+
+                    return true;
+                }
+
+                // The key may have become pending while waiting, so the lookup is repeated.
+                ++waitingProducers_;
+                const auto hasSpace = internal::wait_until(notFull_, lock, deadline,
+                                                           [this] { return !isFull() || closed_; });
+                --waitingProducers_;
+
+                if (!hasSpace)
+                    return false;
+            }
+
+            return false;
+        }
+
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                closed_ = true;
+            }
+
+            notEmpty_.notify_all();
+            notFull_.notify_all();
+        }
+
+        void run()
+        {
+            // Keeps its capacity between the batches.
+            auto&& batch = std::vector<ForwardType>();
+
+            try
+            {
+                while (true)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(guard_);
+
+                        notEmpty_.wait(lock, [this] { return !pending_.empty() || closed_; });
+
+                        if (pending_.empty())
+                            return;
+
+                        batch.swap(pending_);
+                        indices_.clear();
+
+                        const auto notifyProducers = waitingProducers_ != 0;
+
+                        lock.unlock();
+
+                        if (notifyProducers)
+                            notFull_.notify_all();
+                    }
+
+                    for (auto& value : batch)
+                        processor_(std::move(value));
+
+                    batch.clear();
+                }
+            }
+            catch (...)
+            {
+                // Producers must not wait for a conveyor, that is not processed anymore.
+                close();
+                throw;
+            }
+        }
+
+    private:
+        KeyFunction key_;
+        ProcessorFunction processor_;
+        MergeFunction merge_;
+
+        const std::size_t capacity_;
+
+        // The pending values in the order their keys were pushed first and their indices by key.
+        std::vector<ForwardType> pending_;
+        flat_hash_map<Key, std::size_t, Hash> indices_;
+
+        std::mutex guard_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+        std::size_t waitingProducers_ { 0 };
+        bool closed_ { false };
+
+        std::future<void> processorHandle_;
+    };
+
+    /**@}*/
+
+} // jstd
@@ -22,105 +22,183 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <queue>
 #include <future>
+#include <functional>
+#include <memory>
+#include <stdexcept>
 #include <type_traits>
-#include <mutex>
-#include <condition_variable>
+#include <vector>
+
+#include "internal/conveyor_queue.h"
 
 namespace jstd
 {
-    template <typename ForwardType>
-    class conveyor
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Passes pushed values to a processor function that runs on one or more separated threads.
+     *
+     * @tparam ForwardType Type of the pushed values.
+     * @tparam Queue Type of the queue that transfers the values to the processor thread.
+     * <ul>
+     *     <li>blocking_queue (default) can be pushed to from any number of threads.</li>
+     *     <li>mpmc_queue is lock-free and can be pushed to and processed by any number of threads.</li>
+     *     <li>mpsc_queue is lock-free and can be pushed to from any number of threads.</li>
+     *     <li>spsc_queue is lock-free, but must only be pushed to from a single thread at a time.</li>
+     * </ul>
+     * @tparam Processor Type of the processor function with the signature @code void(ForwardType&&) @endcode
+     * The default std::function keeps the type of the conveyor independent of the processor. A concrete callable type
+     * avoids the indirect call per value and allows the processor to be inlined, see make_conveyor.
+     * @tparam Statistics Either no_statistics (default) or conveyor_statistics, which enables stats().
+     * @tparam Flush Either no_flush (default) or conveyor_flush, which enables flush() and flush_async().
+     */
+    template <typename ForwardType,
+              typename Queue = blocking_queue<ForwardType>,
+              typename Processor = std::function<void(ForwardType&&)>,
+              typename Statistics = no_statistics,
+              typename Flush = no_flush>
+    class conveyor : public internal::conveyor_queue<ForwardType, Queue, Statistics, Flush>
     {
-        static_assert(std::is_move_constructible<ForwardType>::value,
-                      "The template parameter is not move constructable. "
-                      "If this type cannot be made move constructable use std::unique_ptr<T>.");
+        using base_type = internal::conveyor_queue<ForwardType, Queue, Statistics, Flush>;
+        using typename base_type::stored_type;
+        using base_type::queue_;
+        using base_type::statistics_;
+        using base_type::barrier_;
 
     public:
-        using ProcessorFunction = std::function<void(ForwardType&&)>;
+        using ProcessorFunction = Processor;
 
     public:
-        explicit conveyor(const ProcessorFunction& processor)
-            : processor_(processor)
-            , processorHandle_(std::async(std::launch::async, [this] { run(); }))
+        explicit conveyor(const ProcessorFunction& processor, const conveyor_options& options = conveyor_options())
+            : base_type(options, options.threads)
+            , processor_(processor)
         {
+            start(options);
         }
 
-        explicit conveyor(ProcessorFunction&& processor)
-            : processor_(std::move(processor))
-            , processorHandle_(std::async(std::launch::async, [this] { run(); }))
+        explicit conveyor(ProcessorFunction&& processor, const conveyor_options& options = conveyor_options())
+            : base_type(options, options.threads)
+            , processor_(std::move(processor))
         {
+            start(options);
         }
 
+        /**
+         * @brief Waits until all pushed values have been processed.
+         */
         ~conveyor()
         {
-            {
-                std::lock_guard<std::mutex> lock(guard_);
-                shouldFinish_ = true;
-            }
-
-            cv_.notify_one();
+            queue_.close();
 
-            processorHandle_.wait();
+            for (auto& processorHandle : processorHandles_)
+                processorHandle.wait();
         }
 
-        void push(ForwardType&& forwardValue)
-        {
-            push_internal(std::move(forwardValue));
-        }
+    private:
 
-        template <typename T = ForwardType>
-        void push(const T& forwardValue,
-                  typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        void start(const conveyor_options& options)
         {
-            push_internal(forwardValue);
-        }
+            const auto threads = options.threads;
 
-    private:
+            if (threads > 1 && !Queue::multi_consumer)
+                throw std::invalid_argument("The queue of the conveyor does not support multiple processor threads.");
 
-        template <typename T>
-        void push_internal(T&& forwardValue)
-        {
-            std::unique_lock<std::mutex> lock(guard_);
+            try
+            {
+                // A single processor thread drains the queue batch by batch, multiple processor threads take the
+                // values one by one to share the load.
+                const auto shared = threads > 1;
+
+                do
+                {
+                    const auto thread = processorHandles_.size();
+                    const auto task = [this, thread, shared] { run(thread, shared); };
 
-            queue_.push(std::forward<T>(forwardValue));
+                    processorHandles_.push_back(internal::launch(options, task));
+                }
+                while (processorHandles_.size() < threads);
+            }
+            catch (...)
+            {
+                queue_.close();
 
-            lock.unlock();
-            cv_.notify_one();
+                for (auto& processorHandle : processorHandles_)
+                    processorHandle.wait();
+
+                throw;
+            }
         }
 
-        void run()
+        void run(std::size_t thread, bool shared)
         {
-            while(true)
-            {
-                std::unique_lock<std::mutex> lock(guard_);
+            auto count = std::size_t(0);
 
-                if (queue_.empty() && !shouldFinish_)
-                    cv_.wait(lock, [this] { return !queue_.empty() || shouldFinish_; });
+            const auto process = [this, thread, &count](stored_type&& value)
+            {
+                const auto started = Statistics::now();
+                auto&& forwardValue = statistics_.take(thread, value, started);
 
-                if (!queue_.empty())
-                {
-                    auto value = std::forward<ForwardType>(queue_.front());
-                    queue_.pop();
+                processor_(std::move(forwardValue));
+                statistics_.processed(thread, 1, started);
+                ++count;
 
-                    lock.unlock();
+                this->recycle(forwardValue);
+            };
 
-                    processor_(std::forward<ForwardType>(value));
+            try
+            {
+                // A single processor thread reports its progress to flush only once per batch.
+                while (shared ? queue_.pop(process) : queue_.pop_all(process))
+                {
+                    barrier_.processed(thread, count);
+                    count = 0;
                 }
-                else if (shouldFinish_)
-                    return;
+            }
+            catch (...)
+            {
+                // Producers must not wait for a full queue, that is not consumed anymore.
+                queue_.close();
+                barrier_.stop();
+                throw;
             }
         }
 
     private:
-        std::queue<ForwardType> queue_;
-        std::mutex guard_;
-        std::condition_variable cv_;
-
-        bool shouldFinish_ { false };
-
         ProcessorFunction processor_;
-        std::future<void> processorHandle_;
+        std::vector<std::future<void> > processorHandles_;
     };
+
+    /**
+     * @brief Creates a conveyor that stores the processor by its concrete type instead of a std::function.
+     *
+     * @code
+     * auto&& writer = jstd::make_conveyor<std::string>([&](std::string&& line) { file << line; });
+     * writer->push("text"s);
+     * @endcode
+     *
+     * @tparam ForwardType Type of the pushed values.
+     * @tparam Queue Type of the queue that transfers the values to the processor thread.
+     * @tparam Statistics Either no_statistics (default) or conveyor_statistics, which enables stats().
+     * @tparam Flush Either no_flush (default) or conveyor_flush, which enables flush() and flush_async().
+     * @param processor Callable with the signature @code void(ForwardType&&) @endcode
+     * It is moved into the conveyor, so it does not need to be copyable.
+     * @param options Runtime options of the conveyor.
+     */
+    template <typename ForwardType,
+              typename Queue = blocking_queue<ForwardType>,
+              typename Statistics = no_statistics,
+              typename Flush = no_flush,
+              typename Processor>
+    std::unique_ptr<conveyor<ForwardType, Queue, typename std::decay<Processor>::type, Statistics, Flush> >
+    make_conveyor(Processor&& processor, const conveyor_options& options = conveyor_options())
+    {
+        using conveyor_type = conveyor<ForwardType, Queue, typename std::decay<Processor>::type, Statistics, Flush>;
+
+        return std::make_unique<conveyor_type>(std::forward<Processor>(processor), options);
+    }
+
+    /**@}*/
 }
\ No newline at end of file
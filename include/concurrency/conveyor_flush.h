@@ -0,0 +1,77 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+
+#include "internal/flush_barrier.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Flush policy of a conveyor that does not support flush.
+     *
+     * This is the default of all conveyors. All of its functions are empty, so they compile away and neither the
+     * producers nor the processor threads share a counter.
+     */
+    struct no_flush
+    {
+        static const bool enabled = false;
+
+        explicit no_flush(std::size_t)
+        {
+        }
+
+        void pushing()
+        {
+        }
+
+        void rejected()
+        {
+        }
+
+        void processed(std::size_t, std::size_t)
+        {
+        }
+
+        void stop()
+        {
+        }
+    };
+
+    /**
+     * @brief Flush policy of a conveyor that enables flush and flush_async.
+     *
+     * Every push counts the value on a counter shared by all producers, and the processor threads publish the
+     * number of values they have processed.
+     */
+    using conveyor_flush = internal::flush_barrier;
+
+    /**@}*/
+
+} // jstd
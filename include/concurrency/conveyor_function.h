@@ -24,9 +24,12 @@
 
 #include <type_traits>
 
+#include "conveyor_options.h"
+#include "executor.h"
 #include "internal/conveyor_forwarder.h"
 #include "internal/conveyor.h"
 #include "internal/conveyor_assertions.h"
+#include "internal/fused_stage.h"
 
 /**
  * jstd
@@ -34,6 +37,34 @@
  */
 namespace jstd
 {
+    namespace internal
+    {
+        template <typename Callable_0, typename Callable_1, typename... Callable_N>
+        void conveyor_function(const conveyor_options& options,
+                               Callable_0&& callable_0, Callable_1&& callable_1, Callable_N&&... callable_n)
+        {
+            assert_signature<Callable_0, Callable_1, Callable_N...>();
+            static_assert(!is_parallel_stage<typename std::decay<Callable_0>::type>::value,
+                          "The producer can not run in parallel.");
+
+            auto&& conveyor = make_stages<internal::conveyor>(options, std::forward<Callable_1>(callable_1),
+                                                              std::forward<Callable_N>(callable_n)...);
+            try
+            {
+                callable_0(conveyor->forwarder());
+            }
+            catch (...)
+            {
+                conveyor->finish();
+                throw;
+            }
+
+            conveyor->finish();
+            conveyor->checkForError();
+        }
+
+    } // internal
+
     /**
      * @addtogroup concurrency
      * @{
@@ -49,6 +80,9 @@ namespace jstd
      * The synchronization of the forwarded data between the
      * threads is handled by conveyor_function.
      *
+     * The forwarder is a static_forwarder. Producers and converters that take it by its concrete type, instead of
+     * a conveyor_forwarder reference, push without a virtual call.
+     *
      *
      * @tparam Callable_0 Type of the first callable.
      * <ul>
@@ -90,27 +124,113 @@ namespace jstd
      * @param callable_n Parameter pack of more callables.
      * <ul><li>If callable_1 meets the requirements of a consumer, the parameter pack needs to be empty.</li></ul>
      */
-    template <typename Callable_0, typename Callable_1, typename... Callable_N>
+    template <typename Callable_0, typename Callable_1, typename... Callable_N,
+              typename std::enable_if<!std::is_base_of<executor,
+                                                       typename std::decay<Callable_0>::type>::value &&
+                                      !std::is_same<conveyor_options,
+                                                    typename std::decay<Callable_0>::type>::value, int>::type = 0>
     void conveyor_function(Callable_0&& callable_0, Callable_1&& callable_1, Callable_N&&... callable_n)
     {
-        internal::assert_signature<Callable_0, Callable_1, Callable_N...>();
+        internal::conveyor_function(conveyor_options(), std::forward<Callable_0>(callable_0),
+                                    std::forward<Callable_1>(callable_1), std::forward<Callable_N>(callable_n)...);
+    };
+
+    /**
+     * @brief Runs multiple callables like conveyor_function, but borrows the threads for all callables except
+     * the first one from an executor.
+     *
+     * @param executor Executor that runs the threads, like a thread_pool. Reusing its threads avoids the cost of
+     * starting a thread per callable and call.
+     * @param callable_0 The producer.
+     * @param callable_1 The consumer or the first converter.
+     * @param callable_n More converters and the consumer.
+     */
+    template <typename Callable_0, typename Callable_1, typename... Callable_N>
+    void conveyor_function(executor& executor,
+                           Callable_0&& callable_0, Callable_1&& callable_1, Callable_N&&... callable_n)
+    {
+        auto&& options = conveyor_options();
+        options.executor = &executor;
 
-        auto&& conveyor = internal::make_conveyor(std::forward<Callable_1>(callable_1),
-                                                  std::forward<Callable_N>(callable_n)...);
-        try
-        {
-            callable_0(conveyor->getForwarder());
-        }
-        catch (...)
-        {
-            conveyor->finish();
-            throw;
-        }
+        internal::conveyor_function(options, std::forward<Callable_0>(callable_0),
+                                    std::forward<Callable_1>(callable_1), std::forward<Callable_N>(callable_n)...);
+    };
 
-        conveyor->finish();
-        conveyor->checkForError();
+    /**
+     * @brief Runs multiple callables like conveyor_function with the options applied to every callable except the
+     * first one.
+     *
+     * With a capacity every queue between two callables is bounded. A push to a full queue blocks until the
+     * following callable has caught up, so a fast producer is slowed down to the pace of the slowest stage and the
+     * memory stays bounded by the number of callables times twice the capacity, regardless of the size of the
+     * input. A callable holds at most a queue full of values, that it took out at once.
+     * The executor and the CPUs of the options are used for the threads of all callables but the producer.
+     * Options that only apply to other conveyors are ignored.
+     *
+     * @param options Options of the stages.
+     * @param callable_0 The producer.
+     * @param callable_1 The consumer or the first converter.
+     * @param callable_n More converters and the consumer.
+     */
+    template <typename Callable_0, typename Callable_1, typename... Callable_N>
+    void conveyor_function(const conveyor_options& options,
+                           Callable_0&& callable_0, Callable_1&& callable_1, Callable_N&&... callable_n)
+    {
+        internal::conveyor_function(options, std::forward<Callable_0>(callable_0),
+                                    std::forward<Callable_1>(callable_1), std::forward<Callable_N>(callable_n)...);
     };
 
+    /**
+     * @brief Marks a converter or the consumer of conveyor_function to run on multiple threads.
+     *
+     * The replicas take the values from the same queue and forward to the same following callable. The callable is
+     * shared by all replicas, so it must be safe to call it concurrently. The order of the forwarded values is not
+     * preserved.
+     *
+     * @param replicas Number of threads that run the callable. Zero is treated as one.
+     * @param callable The converter or the consumer.
+     * @return The stage that is passed to conveyor_function instead of the callable.
+     */
+    template <typename Callable>
+    internal::parallel_stage<typename std::decay<Callable>::type> parallel(std::size_t replicas, Callable&& callable)
+    {
+        return { replicas, std::forward<Callable>(callable) };
+    }
+
+    /**
+     * @brief Fuses a converter with the following converter or consumer of conveyor_function into a single stage.
+     *
+     * The fused callables run on the same thread and the second one is called directly for every value that the
+     * first one forwards, without a queue in between. This suits trivial callables like projections or filters,
+     * for which a thread of their own costs more than their work. The types of the callables are checked like in
+     * conveyor_function.
+     *
+     * Every callable but the last one gets a forwarder of the fused stage. If it takes a conveyor_forwarder
+     * reference, this is a final forwarder, that calls the following callable for every value, so the push is a
+     * direct call once the callable is inlined into the fused stage. If it takes a static_forwarder reference, its
+     * values are buffered and passed to the following callable, once it has returned. Both calls are direct then,
+     * whether or not the callable is inlined. The last callable takes the forwarder of the stage like any other
+     * converter.
+     *
+     * @param first The converter.
+     * @param second The following converter or consumer.
+     * @param more More callables, which are fused in order.
+     * @return A converter, if the last callable is a converter, otherwise a consumer.
+     */
+    template <typename First, typename Second>
+    internal::fused_stage<First, Second> fuse(First&& first, Second&& second)
+    {
+        return { std::forward<First>(first), std::forward<Second>(second) };
+    }
+
+    template <typename First, typename Second, typename Third, typename... More>
+    auto fuse(First&& first, Second&& second, Third&& third, More&&... more)
+    {
+        // Fused from the back, so that the first callable of every fused pair is one of the given callables.
+        return fuse(std::forward<First>(first), fuse(std::forward<Second>(second), std::forward<Third>(third),
+                                                     std::forward<More>(more)...));
+    }
+
     /**@}*/
 
 } // jstd
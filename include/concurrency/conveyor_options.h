@@ -0,0 +1,156 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <chrono>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "executor.h"
+#include "internal/affinity.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Runtime options of a conveyor.
+     */
+    struct conveyor_options
+    {
+        /**
+         * @brief Maximum number of values that wait for the processor.
+         *
+         * If the queue is full, push blocks until the processor has caught up. Zero selects the default capacity of
+         * the queue, which is unbounded for blocking_queue.
+         */
+        std::size_t capacity = 0;
+
+        /**
+         * @brief Number of threads that run the processor of a conveyor concurrently.
+         *
+         * More than one thread requires a queue that supports multiple consumers, like blocking_queue or mpmc_queue.
+         * The values are then processed in parallel and no longer strictly in the order they were pushed.
+         */
+        std::size_t threads = 1;
+
+        /**
+         * @brief Maximum number of results an ordered_conveyor holds back until the results before them are done.
+         *
+         * A processor thread that finishes a value too far ahead waits until the sink has caught up. Zero selects
+         * four times the number of threads.
+         */
+        std::size_t reorder_capacity = 0;
+
+        /**
+         * @brief Number of values a priority_conveyor processes by priority, before it processes the oldest pending
+         * value regardless of its priority.
+         *
+         * This guarantees progress for values of low priority, while values of high priority arrive faster than they
+         * are processed. Zero disables the guard.
+         */
+        std::size_t starvation_limit = 0;
+
+        /**
+         * @brief Maximum number of values a batch_conveyor passes with a single call to its processor.
+         *
+         * A batch is passed as soon as it is full, even if more values are queued. Zero means no limit.
+         */
+        std::size_t batch_size = 0;
+
+        /**
+         * @brief Time a batch_conveyor waits for more values after the first value of a batch has been taken.
+         *
+         * Under light load this collects the values of a burst into one batch instead of passing each of them
+         * alone, at the cost of latency. An incomplete batch is passed once the delay has expired or the conveyor
+         * is destroyed. Zero passes the batch as soon as the queue has been drained.
+         *
+         * The delay starts when the processor takes the first value, not when that value was pushed. Values are
+         * not stamped on push, so a value that is queued while the processor is busy with the previous batch can
+         * wait longer than the delay in total.
+         */
+        std::chrono::microseconds batch_delay { 0 };
+
+        /**
+         * @brief Number of processed values a conveyor or batch_conveyor keeps, so that the producers can reuse them
+         * by acquire().
+         *
+         * A value that the processor leaves intact, like a string it only reads, keeps its buffer and the push of
+         * an acquired value does not allocate. Zero disables the recycling.
+         */
+        std::size_t recycle_capacity = 0;
+
+        /**
+         * @brief CPUs the processor threads of a conveyor are pinned to.
+         *
+         * Placing the processor next to its producers, for example on the same socket, keeps the values in the
+         * shared caches. Threads of an executor are only pinned while they run the conveyor. Empty leaves the
+         * placement to the operating system. Only supported on Linux.
+         */
+        std::vector<unsigned> cpus {};
+
+        /**
+         * @brief NUMA node the queue of a conveyor or batch_conveyor allocates its storage on.
+         *
+         * Only the queues with a preallocated ring, spsc_queue and mpmc_queue, can be placed. Their ring is placed
+         * before it is touched, so its pages are allocated on the node. The other queues allocate while they are
+         * used and throw std::invalid_argument, if a node is given. A negative node leaves the placement to the
+         * operating system. Only supported on Linux.
+         */
+        int numa_node = -1;
+
+        /**
+         * @brief Executor that runs the processor threads of a conveyor, like a thread_pool.
+         *
+         * By default every conveyor starts its own threads. The executor must outlive the conveyor.
+         */
+        jstd::executor* executor = nullptr;
+    };
+
+    /**@}*/
+
+    namespace internal
+    {
+        // Runs a processor task of a conveyor on the executor and the CPUs of the options.
+        template <typename Task>
+        std::future<void> launch(const conveyor_options& options, Task&& task)
+        {
+            if (options.cpus.empty())
+                return launch(options.executor, std::forward<Task>(task));
+
+            return launch(options.executor,
+                          [cpus = options.cpus, task = std::forward<Task>(task)]() mutable
+                          {
+                              const affinity_scope pinned(cpus);
+                              task();
+                          });
+        }
+
+    } // internal
+
+} // jstd
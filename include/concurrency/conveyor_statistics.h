@@ -0,0 +1,428 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "internal/cache_line.h"
+#include "internal/rebind_queue.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Snapshot of a histogram of durations with logarithmic buckets.
+     *
+     * Bucket 0 counts durations below one nanosecond, bucket i counts durations from 2^(i-1) up to 2^i - 1
+     * nanoseconds. The last bucket also counts all longer durations.
+     */
+    struct latency_histogram
+    {
+        static const std::size_t bucket_count = 64;
+
+        std::array<std::uint64_t, bucket_count> buckets {};
+
+        /**
+         * @brief Number of measured durations.
+         */
+        std::uint64_t count() const
+        {
+            auto result = std::uint64_t(0);
+
+            for (const auto bucket : buckets)
+                result += bucket;
+
+            return result;
+        }
+
+        /**
+         * @brief Upper bound of the bucket that contains the given fraction of all durations, e.g. 0.99 for the
+         * 99th percentile.
+         */
+        std::chrono::nanoseconds percentile(double fraction) const
+        {
+            const auto total = count();
+            const auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(total));
+            auto seen = std::uint64_t(0);
+
+            for (auto i = std::size_t(0); i < bucket_count; ++i)
+            {
+                seen += buckets[i];
+
+                if (seen > rank || seen == total)
+                    return upper_bound(i);
+            }
+
+            return std::chrono::nanoseconds(0);
+        }
+
+        /**
+         * @brief Largest duration that is counted in the given bucket.
+         */
+        static std::chrono::nanoseconds upper_bound(std::size_t bucket)
+        {
+            return std::chrono::nanoseconds(static_cast<std::int64_t>((std::uint64_t(1) << bucket) - 1));
+        }
+
+        /**
+         * @brief Index of the bucket that counts the given duration in nanoseconds.
+         */
+        static std::size_t bucket(std::uint64_t nanoseconds)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return nanoseconds == 0 ? 0 : std::min<std::size_t>(64 - __builtin_clzll(nanoseconds), bucket_count - 1);
+#else
+            auto result = std::size_t(0);
+
+            while (nanoseconds != 0 && result < bucket_count - 1)
+            {
+                nanoseconds >>= 1;
+                ++result;
+            }
+
+            return result;
+#endif
+        }
+    };
+
+    /**
+     * @brief Snapshot of the statistics of a conveyor.
+     *
+     * The throughput follows from the difference of the processed values of two snapshots.
+     */
+    struct conveyor_stats
+    {
+        /**
+         * @brief Number of values that have been pushed. A push that is still in progress may already be counted,
+         * but a value is always counted as pushed before it is counted as processed.
+         */
+        std::uint64_t pushed = 0;
+
+        /**
+         * @brief Number of values that have been passed to the processor and returned from it.
+         */
+        std::uint64_t processed = 0;
+
+        /**
+         * @brief Total time the values spent in the queue until they were passed to the processor.
+         */
+        std::chrono::nanoseconds wait_time { 0 };
+
+        /**
+         * @brief Total time spent inside the processor.
+         */
+        std::chrono::nanoseconds service_time { 0 };
+
+        latency_histogram wait_histogram;
+
+        /**
+         * @brief Histogram of the durations of the processor calls. A batch_conveyor calls its processor once per
+         * batch.
+         */
+        latency_histogram service_histogram;
+
+        /**
+         * @brief Number of values that have been pushed, but not processed yet.
+         */
+        std::uint64_t depth() const
+        {
+            return pushed > processed ? pushed - processed : 0;
+        }
+    };
+
+    namespace internal
+    {
+        // Stores the time a value was pushed next to the value.
+        template <typename T>
+        struct timed_value;
+
+        // Refers to a value that is being pushed. The queue only moves it into a timed_value, if the push succeeds.
+        template <typename U>
+        struct timed_reference
+        {
+            U&& value;
+            std::chrono::steady_clock::time_point pushed;
+        };
+
+        template <typename T>
+        struct timed_value
+        {
+            template <typename U>
+            timed_value(timed_reference<U>&& reference)
+                : value(std::forward<U>(reference.value))
+                , pushed(reference.pushed)
+            {
+            }
+
+            template <typename... Args>
+            explicit timed_value(std::chrono::steady_clock::time_point pushed, Args&&... args)
+                : value(std::forward<Args>(args)...)
+                , pushed(pushed)
+            {
+            }
+
+            T value;
+            std::chrono::steady_clock::time_point pushed;
+        };
+
+        // Empty time stamp of a conveyor without statistics.
+        struct no_time_point {};
+
+        // Index of the calling thread, that spreads the producers over the stripes of a counter.
+        inline std::size_t producer_stripe()
+        {
+            static std::atomic<std::size_t> next { 0 };
+            thread_local const auto stripe = next.fetch_add(1, std::memory_order_relaxed);
+
+            return stripe;
+        }
+
+    } // internal
+
+    /**
+     * @brief Statistics policy of a conveyor that does not measure anything.
+     *
+     * This is the default of all conveyors. All of its functions are empty, so they compile away.
+     */
+    struct no_statistics
+    {
+        static const bool enabled = false;
+
+        using time_point = internal::no_time_point;
+
+        template <typename Queue>
+        using queue_type = Queue;
+
+        explicit no_statistics(std::size_t)
+        {
+        }
+
+        static time_point now()
+        {
+            return time_point();
+        }
+
+        template <typename U>
+        static U&& stamp(U&& value)
+        {
+            return std::forward<U>(value);
+        }
+
+        template <typename Queue, typename... Args>
+        static bool emplace(Queue& queue, Args&&... args)
+        {
+            return queue.emplace(std::forward<Args>(args)...);
+        }
+
+        template <typename T>
+        T&& take(std::size_t, T& stored, time_point)
+        {
+            return std::move(stored);
+        }
+
+        void pushing()
+        {
+        }
+
+        void rejected()
+        {
+        }
+
+        void processed(std::size_t, std::size_t, time_point)
+        {
+        }
+    };
+
+    /**
+     * @brief Statistics policy of a conveyor that counts the values and measures how long they wait and how long
+     * the processor takes.
+     *
+     * Every value is stored with the time it was pushed. Each processor thread updates counters of its own with
+     * relaxed atomics, that are only summed up by stats(), so the processor threads never contend with each other.
+     * The producers count their values on a striped counter, so that producers on different threads usually
+     * update different cache lines.
+     */
+    class conveyor_statistics
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Written only by a single processor thread, read by stats().
+        struct processor_counters
+        {
+            std::atomic<std::uint64_t> processed { 0 };
+            std::atomic<std::uint64_t> waitTime { 0 };
+            std::atomic<std::uint64_t> serviceTime { 0 };
+            std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count> waitHistogram {};
+            std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count> serviceHistogram {};
+
+            char padding_[internal::cache_line_size];
+        };
+
+        struct producer_counter
+        {
+            std::atomic<std::uint64_t> pushed { 0 };
+
+            char padding_[internal::cache_line_size];
+        };
+
+        static const std::size_t producer_stripes = 16;
+
+    public:
+        static const bool enabled = true;
+
+        using time_point = clock::time_point;
+
+        template <typename Queue>
+        using queue_type =
+                typename internal::rebind_queue<Queue, internal::timed_value<typename Queue::value_type> >::type;
+
+        /**
+         * @param threads Number of processor threads.
+         */
+        explicit conveyor_statistics(std::size_t threads)
+            : threads_(threads == 0 ? 1 : threads)
+            , counters_(new processor_counters[threads_])
+            , producers_(new producer_counter[producer_stripes])
+        {
+        }
+
+        static time_point now()
+        {
+            return clock::now();
+        }
+
+        template <typename U>
+        static internal::timed_reference<U> stamp(U&& value)
+        {
+            return internal::timed_reference<U> { std::forward<U>(value), now() };
+        }
+
+        template <typename Queue, typename... Args>
+        static bool emplace(Queue& queue, Args&&... args)
+        {
+            return queue.emplace(now(), std::forward<Args>(args)...);
+        }
+
+        template <typename T>
+        T&& take(std::size_t thread, internal::timed_value<T>& stored, time_point taken)
+        {
+            auto& counters = counters_[thread];
+
+            record(counters.waitTime, counters.waitHistogram, taken - stored.pushed);
+
+            return std::move(stored.value);
+        }
+
+        // A value is counted before it is queued and taken back, if the push fails, so that it cannot be counted
+        // as processed before it is counted as pushed.
+        void pushing()
+        {
+            stripe().pushed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void rejected()
+        {
+            stripe().pushed.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void processed(std::size_t thread, std::size_t count, time_point started)
+        {
+            auto& counters = counters_[thread];
+
+            // Released, so that stats() sees the pushes of all values it sees processed.
+            counters.processed.store(counters.processed.load(std::memory_order_relaxed) + count,
+                                     std::memory_order_release);
+            record(counters.serviceTime, counters.serviceHistogram, now() - started);
+        }
+
+        conveyor_stats snapshot() const
+        {
+            auto&& result = conveyor_stats();
+
+            for (auto thread = std::size_t(0); thread < threads_; ++thread)
+            {
+                const auto& counters = counters_[thread];
+
+                result.processed += counters.processed.load(std::memory_order_acquire);
+                result.wait_time += std::chrono::nanoseconds(counters.waitTime.load(std::memory_order_relaxed));
+                result.service_time +=
+                        std::chrono::nanoseconds(counters.serviceTime.load(std::memory_order_relaxed));
+
+                for (auto i = std::size_t(0); i < latency_histogram::bucket_count; ++i)
+                {
+                    result.wait_histogram.buckets[i] += counters.waitHistogram[i].load(std::memory_order_relaxed);
+                    result.service_histogram.buckets[i] +=
+                            counters.serviceHistogram[i].load(std::memory_order_relaxed);
+                }
+            }
+
+            // Read last, so that values processed during the snapshot do not let processed exceed pushed. A push
+            // that is still in progress or about to fail may already be counted.
+            for (auto i = std::size_t(0); i < producer_stripes; ++i)
+                result.pushed += producers_[i].pushed.load(std::memory_order_relaxed);
+
+            return result;
+        }
+
+    private:
+        producer_counter& stripe()
+        {
+            return producers_[internal::producer_stripe() % producer_stripes];
+        }
+
+        // Only the owning thread writes the counter, so a plain load and store is sufficient.
+        static void add(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        static void record(std::atomic<std::uint64_t>& total,
+                           std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count>& histogram,
+                           clock::duration duration)
+        {
+            const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            const auto value = nanoseconds > 0 ? static_cast<std::uint64_t>(nanoseconds) : 0;
+
+            add(total, value);
+            add(histogram[latency_histogram::bucket(value)], 1);
+        }
+
+    private:
+        const std::size_t threads_;
+        const std::unique_ptr<processor_counters[]> counters_;
+        const std::unique_ptr<producer_counter[]> producers_;
+    };
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,380 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#if !defined(__cpp_impl_coroutine)
+#error "coroutine_conveyor.h requires C++20 coroutines."
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "conveyor_options.h"
+#include "internal/chunked_queue.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Return type of a coroutine that runs on its own, like a consumer of a coroutine_conveyor.
+     *
+     * The coroutine starts right away on the calling thread and frees itself when it has finished. An exception
+     * that leaves the coroutine terminates the program.
+     */
+    struct detached_task
+    {
+        struct promise_type
+        {
+            detached_task get_return_object() noexcept
+            {
+                return {};
+            }
+
+            std::suspend_never initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            std::suspend_never final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void return_void() noexcept
+            {
+            }
+
+            void unhandled_exception() noexcept
+            {
+                std::terminate();
+            }
+        };
+    };
+
+    /**
+     * @brief Passes values from producer to consumer coroutines, without blocking a thread.
+     *
+     * A producer that pushes to a full conveyor and a consumer that pops from an empty one are suspended instead
+     * of blocking their thread. They are resumed on the executor of the options, once a value or free space is
+     * available, or directly on the thread that made it available, if there is no executor. Many conveyors can
+     * so share a few threads.
+     *
+     * @code
+     * auto&& lines = jstd::coroutine_conveyor<std::string>(options);
+     *
+     * jstd::detached_task produce() { co_await lines.push("text"s); lines.close(); }
+     * jstd::detached_task consume() { while (auto line = co_await lines.pop()) file << *line; }
+     * @endcode
+     *
+     * All suspended coroutines must have been resumed before the conveyor is destroyed, for example by close().
+     *
+     * @tparam ForwardType Type of the pushed values.
+     */
+    template <typename ForwardType>
+    class coroutine_conveyor
+    {
+        // Suspended coroutines are linked through their awaiters, which live in the coroutine frames.
+        template <typename Awaiter>
+        struct waiting_list
+        {
+            bool empty() const
+            {
+                return !first;
+            }
+
+            void push(Awaiter* awaiter)
+            {
+                awaiter->next = nullptr;
+                (last ? last->next : first) = awaiter;
+                last = awaiter;
+            }
+
+            Awaiter* pop()
+            {
+                const auto result = first;
+
+                if (!(first = first->next))
+                    last = nullptr;
+
+                return result;
+            }
+
+            Awaiter* first = nullptr;
+            Awaiter* last = nullptr;
+        };
+
+    public:
+        class push_awaiter
+        {
+        public:
+            template <typename... Args>
+            explicit push_awaiter(coroutine_conveyor& conveyor, Args&&... args)
+                : conveyor_(conveyor)
+                , value_(std::forward<Args>(args)...)
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                handle_ = handle;
+                return conveyor_.suspendProducer(this);
+            }
+
+            /**
+             * @return false, if the conveyor has been closed and the value was not pushed.
+             */
+            bool await_resume() const noexcept
+            {
+                return pushed_;
+            }
+
+        private:
+            friend class coroutine_conveyor;
+            friend struct waiting_list<push_awaiter>;
+
+            coroutine_conveyor& conveyor_;
+            ForwardType value_;
+            std::coroutine_handle<> handle_;
+            push_awaiter* next = nullptr;
+            bool pushed_ = false;
+        };
+
+        class pop_awaiter
+        {
+        public:
+            explicit pop_awaiter(coroutine_conveyor& conveyor)
+                : conveyor_(conveyor)
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                handle_ = handle;
+                return conveyor_.suspendConsumer(this);
+            }
+
+            /**
+             * @return The next value, or no value, if the conveyor has been closed and all values have been popped.
+             */
+            std::optional<ForwardType> await_resume()
+            {
+                return std::move(value_);
+            }
+
+        private:
+            friend class coroutine_conveyor;
+            friend struct waiting_list<pop_awaiter>;
+
+            coroutine_conveyor& conveyor_;
+            std::optional<ForwardType> value_;
+            std::coroutine_handle<> handle_;
+            pop_awaiter* next = nullptr;
+        };
+
+    public:
+        /**
+         * @param options The capacity bounds the number of queued values, zero means unbounded. The executor
+         * resumes the suspended coroutines.
+         */
+        explicit coroutine_conveyor(const conveyor_options& options = conveyor_options())
+            : capacity_(options.capacity)
+            , executor_(options.executor)
+            , values_(chunks_)
+        {
+        }
+
+        coroutine_conveyor(const coroutine_conveyor&) = delete;
+        coroutine_conveyor& operator=(const coroutine_conveyor&) = delete;
+
+        /**
+         * @brief Returns an awaitable that pushes the value and suspends the producer, while the conveyor is full.
+         *
+         * The result of co_await is false, if the conveyor has been closed and the value was not pushed.
+         */
+        template <typename U>
+        push_awaiter push(U&& value)
+        {
+            return push_awaiter(*this, std::forward<U>(value));
+        }
+
+        /**
+         * @brief Returns an awaitable that constructs a value in place, like push.
+         */
+        template <typename... Args>
+        push_awaiter emplace(Args&&... args)
+        {
+            return push_awaiter(*this, std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Returns an awaitable that takes the next value and suspends the consumer, while the conveyor is
+         * empty.
+         *
+         * The result of co_await is an empty optional, once the conveyor has been closed and all values have
+         * been popped.
+         */
+        pop_awaiter pop()
+        {
+            return pop_awaiter(*this);
+        }
+
+        /**
+         * @brief Rejects all further values and resumes all suspended producers and consumers.
+         *
+         * Values that were pushed before can still be popped.
+         */
+        void close()
+        {
+            auto&& producers = waiting_list<push_awaiter>();
+            auto&& consumers = waiting_list<pop_awaiter>();
+
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                closed_ = true;
+                std::swap(producers, producers_);
+                std::swap(consumers, consumers_);
+            }
+
+            while (!producers.empty())
+                resume(producers.pop()->handle_);
+
+            while (!consumers.empty())
+                resume(consumers.pop()->handle_);
+        }
+
+    private:
+        bool isFull() const
+        {
+            return capacity_ != 0 && values_.size() >= capacity_;
+        }
+
+        // Returns false, if the producer continues without being suspended.
+        bool suspendProducer(push_awaiter* producer)
+        {
+            auto consumer = static_cast<pop_awaiter*>(nullptr);
+
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                if (closed_)
+                    return false;
+
+                if (!consumers_.empty())
+                {
+                    // The conveyor is empty, the value is handed over directly.
+                    consumer = consumers_.pop();
+                    consumer->value_.emplace(std::move(producer->value_));
+                }
+                else if (!isFull())
+                    values_.emplace(std::move(producer->value_));
+                else
+                {
+                    producers_.push(producer);
+                    return true;
+                }
+
+                producer->pushed_ = true;
+            }
+
+            if (consumer)
+                resume(consumer->handle_);
+
+            return false;
+        }
+
+        // Returns false, if the consumer continues without being suspended.
+        bool suspendConsumer(pop_awaiter* consumer)
+        {
+            auto producer = static_cast<push_awaiter*>(nullptr);
+
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                if (values_.empty())
+                {
+                    if (closed_)
+                        return false;
+
+                    consumers_.push(consumer);
+                    return true;
+                }
+
+                consumer->value_.emplace(std::move(values_.front()));
+                values_.pop();
+
+                // The free space is passed on to the first suspended producer.
+                if (!producers_.empty())
+                {
+                    producer = producers_.pop();
+                    values_.emplace(std::move(producer->value_));
+                    producer->pushed_ = true;
+                }
+            }
+
+            if (producer)
+                resume(producer->handle_);
+
+            return false;
+        }
+
+        void resume(std::coroutine_handle<> handle)
+        {
+            if (executor_)
+                executor_->execute([handle] { handle.resume(); });
+            else
+                handle.resume();
+        }
+
+    private:
+        const std::size_t capacity_;
+        jstd::executor* const executor_;
+
+        internal::chunk_pool<ForwardType> chunks_;
+        internal::chunked_queue<ForwardType> values_;
+        waiting_list<push_awaiter> producers_;
+        waiting_list<pop_awaiter> consumers_;
+        std::mutex guard_;
+        bool closed_ = false;
+    };
+
+    /**@}*/
+
+} // jstd
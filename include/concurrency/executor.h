@@ -0,0 +1,77 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Interface of an object that runs tasks on threads it manages, like thread_pool.
+     *
+     * Conveyors run their processors as tasks on an executor, if one is given in the conveyor_options.
+     * Otherwise every conveyor starts its own threads.
+     */
+    class executor
+    {
+    public:
+        virtual ~executor() = default;
+
+        /**
+         * @brief Runs the task on another thread.
+         *
+         * The task of a conveyor blocks its thread until the conveyor is destroyed. The executor must therefore
+         * not let tasks wait for each other.
+         */
+        virtual void execute(std::function<void()>&& task) = 0;
+    };
+
+    /**@}*/
+
+    namespace internal
+    {
+        template <typename Task>
+        std::future<void> launch(executor* executor, Task&& task)
+        {
+            if (!executor)
+                return std::async(std::launch::async, std::forward<Task>(task));
+
+            // std::function needs a copyable target.
+            auto&& packagedTask = std::make_shared<std::packaged_task<void()> >(std::forward<Task>(task));
+            auto&& result = packagedTask->get_future();
+
+            executor->execute([packagedTask] { (*packagedTask)(); });
+
+            return std::move(result);
+        }
+
+    } // internal
+
+} // jstd
@@ -0,0 +1,180 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Pins the calling thread to a set of CPUs while it is in scope. The previous affinity is restored
+        // afterwards, so that the threads of an executor are handed back unchanged. CPUs that do not exist are
+        // ignored and the thread stays unpinned, if none is left. Only supported on Linux.
+        class affinity_scope
+        {
+        public:
+            explicit affinity_scope(const std::vector<unsigned>& cpus)
+            {
+#ifdef __linux__
+                if (cpus.empty() || pthread_getaffinity_np(pthread_self(), sizeof(previous_), &previous_) != 0)
+                    return;
+
+                auto pinned = cpu_set_t();
+                CPU_ZERO(&pinned);
+
+                for (const auto cpu : cpus)
+                {
+                    if (cpu < CPU_SETSIZE)
+                        CPU_SET(cpu, &pinned);
+                }
+
+                pinned_ = pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned) == 0;
+#else
+                (void)cpus;
+#endif
+            }
+
+            affinity_scope(const affinity_scope&) = delete;
+            affinity_scope& operator=(const affinity_scope&) = delete;
+
+            ~affinity_scope()
+            {
+#ifdef __linux__
+                if (pinned_)
+                    pthread_setaffinity_np(pthread_self(), sizeof(previous_), &previous_);
+#endif
+            }
+
+            bool pinned() const
+            {
+                return pinned_;
+            }
+
+        private:
+#ifdef __linux__
+            cpu_set_t previous_;
+#endif
+            bool pinned_ = false;
+        };
+
+        // Memory block, that is placed on a NUMA node before any of its pages is touched, so that the pages are
+        // allocated on the node instead of being moved there later. A negative node allocates the block from the
+        // heap. The node is only preferred, the kernel falls back to other nodes, if it runs out of memory. Only
+        // supported on Linux, other platforms allocate the block from the heap.
+        class node_memory
+        {
+        public:
+            node_memory(std::size_t size, int node)
+                : size_(size)
+            {
+#if defined(__linux__) && defined(SYS_mbind)
+                if (node >= 0)
+                {
+                    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+                    mapped_ = (size + pageSize - 1) / pageSize * pageSize;
+                    memory_ = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+                    if (memory_ == MAP_FAILED)
+                        throw std::bad_alloc();
+
+                    placed_ = bind(memory_, mapped_, node);
+                    return;
+                }
+#else
+                (void)node;
+#endif
+                memory_ = ::operator new(size);
+            }
+
+            node_memory(const node_memory&) = delete;
+            node_memory& operator=(const node_memory&) = delete;
+
+            ~node_memory()
+            {
+#ifdef __linux__
+                if (mapped_ != 0)
+                {
+                    munmap(memory_, mapped_);
+                    return;
+                }
+#endif
+                ::operator delete(memory_);
+            }
+
+            void* get() const
+            {
+                return memory_;
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+            // Whether the kernel accepted the node for the block.
+            bool placed() const
+            {
+                return placed_;
+            }
+
+        private:
+#if defined(__linux__) && defined(SYS_mbind)
+            static bool bind(void* address, std::size_t size, int node)
+            {
+                // From <numaif.h>, which is part of libnuma and not always installed.
+                const auto preferred = 1;
+
+                const auto bits = sizeof(unsigned long) * 8;
+                unsigned long nodes[4] = {};
+
+                if (static_cast<std::size_t>(node) >= sizeof(nodes) * 8)
+                    return false;
+
+                nodes[node / bits] = 1ul << (node % bits);
+
+                return syscall(SYS_mbind, address, size, preferred, nodes, sizeof(nodes) * 8 + 1, 0) == 0;
+            }
+#endif
+
+        private:
+            const std::size_t size_;
+            void* memory_ = nullptr;
+            std::size_t mapped_ = 0;
+            bool placed_ = false;
+        };
+
+    } // internal
+
+} // jstd
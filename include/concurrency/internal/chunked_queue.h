@@ -0,0 +1,230 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "cache_line.h"
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Size of a chunk of chunked_queue. A page keeps the chunks of small values apart from each other and
+        // still holds a few large values.
+        constexpr std::size_t chunk_size = 4096;
+
+        // Fixed-size block of values that is linked into a chunked_queue.
+        template <typename T>
+        struct queue_chunk
+        {
+            static constexpr std::size_t header_size = cache_line_size;
+            static constexpr std::size_t capacity =
+                    sizeof(T) * 8 + header_size > chunk_size ? 8 : (chunk_size - header_size) / sizeof(T);
+
+            queue_chunk* next = nullptr;
+
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type values[capacity];
+
+            T& operator[](std::size_t index)
+            {
+                return reinterpret_cast<T&>(values[index]);
+            }
+        };
+
+        template <typename T>
+        constexpr std::size_t queue_chunk<T>::capacity;
+
+        // Keeps the chunks that a queue has released for reuse, so that a queue that has reached its usual size
+        // does not allocate anymore. The chunks are only freed, when the pool is destroyed.
+        //
+        // A chunk is taken or returned once per chunk of values, so a mutex is cheap enough. It is needed, because
+        // the queues that share a pool are filled and drained by different threads.
+        template <typename T>
+        class chunk_pool
+        {
+        public:
+            using chunk_type = queue_chunk<T>;
+
+        public:
+            chunk_pool() = default;
+
+            chunk_pool(const chunk_pool&) = delete;
+            chunk_pool& operator=(const chunk_pool&) = delete;
+
+            ~chunk_pool()
+            {
+                while (free_)
+                    delete std::exchange(free_, free_->next);
+            }
+
+            chunk_type* acquire()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(guard_);
+
+                    if (free_)
+                    {
+                        const auto result = std::exchange(free_, free_->next);
+                        result->next = nullptr;
+                        return result;
+                    }
+
+                    ++allocated_;
+                }
+
+                return new chunk_type();
+            }
+
+            void release(chunk_type* chunk)
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                chunk->next = free_;
+                free_ = chunk;
+            }
+
+            // Number of chunks the pool has allocated so far.
+            std::size_t allocated() const
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                return allocated_;
+            }
+
+        private:
+            mutable std::mutex guard_;
+            chunk_type* free_ = nullptr;
+            std::size_t allocated_ = 0;
+        };
+
+        // FIFO queue of values in linked chunks, that are taken from and returned to a chunk_pool. It replaces
+        // std::queue, whose deque allocates and frees its blocks as the queue grows and shrinks.
+        //
+        // The queue itself is not thread-safe, only the pool may be shared by queues on different threads.
+        template <typename T>
+        class chunked_queue
+        {
+            using chunk_type = queue_chunk<T>;
+
+        public:
+            explicit chunked_queue(chunk_pool<T>& pool)
+                : pool_(&pool)
+            {
+            }
+
+            chunked_queue(const chunked_queue&) = delete;
+            chunked_queue& operator=(const chunked_queue&) = delete;
+
+            ~chunked_queue()
+            {
+                while (!empty())
+                    pop();
+
+                for (auto chunk = head_; chunk;)
+                    pool_->release(std::exchange(chunk, chunk->next));
+            }
+
+            bool empty() const
+            {
+                return size_ == 0;
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+            T& front()
+            {
+                return (*head_)[headIndex_];
+            }
+
+            template <typename... Args>
+            void emplace(Args&&... args)
+            {
+                if (!tail_)
+                    head_ = tail_ = pool_->acquire();
+
+                // The next chunk is only used once the value has been constructed, so that a throwing constructor
+                // leaves the queue unchanged.
+                const auto full = tailIndex_ == chunk_type::capacity;
+
+                if (full && !tail_->next)
+                    tail_->next = pool_->acquire();
+
+                new (full ? &(*tail_->next)[0] : &(*tail_)[tailIndex_]) T(std::forward<Args>(args)...);
+
+                if (full)
+                {
+                    tail_ = tail_->next;
+                    tailIndex_ = 0;
+                }
+
+                ++tailIndex_;
+                ++size_;
+            }
+
+            void pop()
+            {
+                front().~T();
+
+                ++headIndex_;
+                --size_;
+
+                // The last chunk is kept, so that a queue that breathes around a few values does not touch the pool.
+                if (size_ == 0)
+                    headIndex_ = tailIndex_ = 0;
+                else if (headIndex_ == chunk_type::capacity)
+                {
+                    pool_->release(std::exchange(head_, head_->next));
+                    headIndex_ = 0;
+                }
+            }
+
+            void swap(chunked_queue& other)
+            {
+                std::swap(pool_, other.pool_);
+                std::swap(head_, other.head_);
+                std::swap(tail_, other.tail_);
+                std::swap(headIndex_, other.headIndex_);
+                std::swap(tailIndex_, other.tailIndex_);
+                std::swap(size_, other.size_);
+            }
+
+        private:
+            chunk_pool<T>* pool_;
+
+            chunk_type* head_ = nullptr;
+            chunk_type* tail_ = nullptr;
+            std::size_t headIndex_ = 0;
+            std::size_t tailIndex_ = 0;
+            std::size_t size_ = 0;
+        };
+
+    } // internal
+
+} // jstd
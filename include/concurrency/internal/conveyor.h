@@ -23,12 +23,13 @@
 // SOFTWARE.
 
 #include <memory>
-#include <queue>
-#include <mutex>
 #include <future>
+#include <vector>
 
+#include "../conveyor_options.h"
 #include "conveyor_forwarder.h"
 #include "conveyor_traits.h"
+#include "stage_queue.h"
 
 namespace jstd
 {
@@ -47,31 +48,28 @@ namespace jstd
         template<typename T, typename Callable>
         class conveyor : public conveyor_proxy
         {
-            class conveyor_forwarder_impl : public jstd::conveyor_forwarder<T>
+        public:
+            // Replicas share the queue and call the same consumer concurrently.
+            // The options select the capacity of the queue, the executor and the CPUs of the stage.
+            explicit conveyor(Callable&& consumer, const conveyor_options& options = conveyor_options(),
+                              std::size_t replicas = 1)
+                    : _consumer(std::forward<Callable>(consumer))
+                      , _input(options.capacity)
+                      , _forwarder(_input)
             {
-            public:
-                explicit conveyor_forwarder_impl(conveyor<T, Callable>& forwarder)
-                        : _forwarder(forwarder)
+                try
                 {
-                }
+                    const auto shared = replicas > 1;
 
-                virtual ~conveyor_forwarder_impl() = default;
-
-                void push(T&& forwardValue) override
+                    do
+                        _consumerHandles.push_back(launch(options, [this, shared] { run(shared); }));
+                    while (_consumerHandles.size() < replicas);
+                }
+                catch (...)
                 {
-                    _forwarder.push(std::move(forwardValue));
+                    wait();
+                    throw;
                 }
-
-            private:
-                conveyor<T, Callable>& _forwarder;
-            };
-
-        public:
-            explicit conveyor(Callable&& consumer)
-                    : _consumer(std::forward<Callable>(consumer))
-                      , _forwarder(*this)
-                      , _consumerHandle(std::async(std::launch::async, [this] { run(); }))
-            {
             }
 
             virtual ~conveyor() = default;
@@ -79,23 +77,12 @@ namespace jstd
             template<typename ForwardType>
             void push(ForwardType&& forwardValue)
             {
-                checkForErrorInternal();
-
-                std::unique_lock<std::mutex> lock(_mutex);
-
-                _queue.push(std::forward<ForwardType>(forwardValue));
-
-                lock.unlock();
-                _cv.notify_one();
+                _input.push(std::forward<ForwardType>(forwardValue));
             }
 
             void finish() override
             {
-                _shouldFinish = true;
-                _cv.notify_one();
-
-                if (_consumerHandle.valid())
-                    _consumerHandle.wait();
+                wait();
 
                 if (_proxy)
                     _proxy->finish();
@@ -106,105 +93,56 @@ namespace jstd
                 if (_proxy)
                     _proxy->checkForError();
 
-                checkForErrorInternal();
+                _input.checkForError();
             }
 
-            void setConveyorProxy(std::unique_ptr<conveyor_proxy>&& proxy)
+            void setNext(std::unique_ptr<conveyor_proxy>&& proxy)
             {
                 _proxy = std::move(proxy);
             }
 
-            conveyor_forwarder_impl& getForwarder()
+            static_forwarder<T>& forwarder()
             {
                 return _forwarder;
             }
 
         private:
 
-            void checkForErrorInternal() const
+            void wait()
             {
-                if (_hasError)
-                    rethrow_exception(_error);
+                _input.queue().close();
+
+                for (auto& consumerHandle : _consumerHandles)
+                    consumerHandle.wait();
             }
 
-            void run()
+            void run(bool shared)
             {
+                const auto consume = [this](T&& value) { _consumer(std::move(value)); };
+
                 try
                 {
-                    while (true)
-                    {
-                        std::unique_lock<std::mutex> lock(_mutex);
-
-                        if (_queue.empty() && !_shouldFinish)
-                            _cv.wait(lock, [this]
-                            {
-                                return !_queue.empty() || _shouldFinish;
-                            });
-
-                        if (!_queue.empty())
-                        {
-                            auto value = std::move(_queue.front());
-                            _queue.pop();
-
-                            lock.unlock();
-
-                            _consumer(std::move(value));
-                        }
-                        else if (_shouldFinish)
-                            return;
-                    }
+                    // Only a single consumer may drain the queue at once.
+                    if (shared)
+                        while (_input.queue().pop(consume));
+                    else
+                        while (_input.queue().pop_all(consume));
                 }
                 catch (...)
                 {
-                    _error = std::current_exception();
-                    _hasError = true;
+                    _input.fail(std::current_exception());
                 }
             }
 
-        private:
             std::unique_ptr<conveyor_proxy> _proxy;
-            Callable _consumer;
 
-            std::queue<T> _queue;
-            std::mutex _mutex;
-            std::condition_variable _cv;
-
-            std::atomic<bool> _shouldFinish { false };
-
-            conveyor_forwarder_impl _forwarder;
-            std::future<void> _consumerHandle;
-
-            std::exception_ptr _error;
-            std::atomic<bool> _hasError { false };
-        };
+            Callable _consumer;
+            stage_queue<T> _input;
 
-        template <typename T,
-                  typename SourceType = typename callable_type<T>::source_type,
-                  typename ConveyorType = conveyor<SourceType, T> >
-        std::unique_ptr<ConveyorType> make_conveyor(T&& consumer)
-        {
-            return std::make_unique<ConveyorType>(std::forward<T>(consumer));
+            static_forwarder<T> _forwarder;
+            std::vector<std::future<void> > _consumerHandles;
         };
 
-        template <typename T, typename... Args,
-                  typename SourceType = typename callable_type<T>::source_type,
-                typename std::enable_if<callable_type<T>::callable == Callable::converter, int>::type = 0>
-        auto make_conveyor(T&& converter, Args&&... args)
-        {
-            auto&& conveyor = make_conveyor(std::forward<Args>(args)...);
-            auto& forwarder = conveyor->getForwarder();
-
-            auto&& consumer = [&forwarder, cv = std::forward<T>(converter)](SourceType&& value)
-            {
-                cv(std::move(value), forwarder);
-            };
-
-            auto&& resultConveyor = make_conveyor(std::move(consumer));
-            resultConveyor->setConveyorProxy(std::move(conveyor));
-
-            return std::move(resultConveyor);
-        }
-
     } // internal
 
 } // jstd
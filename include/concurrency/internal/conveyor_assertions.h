@@ -23,6 +23,7 @@
 // SOFTWARE.
 
 #include <type_traits>
+#include <utility>
 
 #include "conveyor_traits.h"
 
@@ -129,7 +130,6 @@ namespace jstd
 
         template<typename First, typename Second, typename... Args>
         struct assert_signature_args<First, Second, Args...> : public assert_converter<First>,
-                                                               public assert_converter<Second>,
                                                                public assert_type_pairs<First, Second>,
                                                                public assert_move_constructible<First>,
                                                                public assert_signature_args<Second, Args...>
@@ -155,5 +155,53 @@ namespace jstd
         {
         };
 
+        template<typename T, typename = void>
+        struct takes_conveyor_forwarder : public std::false_type {};
+
+        template<typename T>
+        struct takes_conveyor_forwarder<T, decltype(std::declval<const T&>()(
+                std::declval<typename callable_type<T>::source_type&&>(),
+                std::declval<conveyor_forwarder<typename callable_type<T>::target_type>&>()), void())>
+                : public std::true_type {};
+
+        template<typename T, typename = void>
+        struct takes_static_forwarder : public std::false_type {};
+
+        template<typename T>
+        struct takes_static_forwarder<T, decltype(std::declval<const T&>()(
+                std::declval<typename callable_type<T>::source_type&&>(),
+                std::declval<static_forwarder<typename callable_type<T>::target_type>&>()), void())>
+                : public std::true_type {};
+
+        // A fused converter gets a forwarder of the fused stage, not the one of the following stage.
+        template<typename T>
+        struct assert_fused_converter
+        {
+            static_assert(takes_conveyor_forwarder<T>::value || takes_static_forwarder<T>::value,
+                          "Invalid type of parameter. A callable, that is fused with the following one, "
+                          "must take a conveyor_forwarder or static_forwarder reference.\n"
+                          "Expected: void('source type'&&, static_forwarder<'target type'>&)");
+        };
+
+        // Callables that are fused into a single stage: a converter followed by a converter or a consumer.
+        template<typename First, typename Second>
+        struct assert_fusible : public assert_converter<First>,
+                                public assert_fused_converter<First>,
+                                public assert_type_pairs<First, Second>,
+                                public assert_move_constructible<First>
+        {
+        };
+
+        // Stages of a pipeline, which get their values pushed instead of from a producer.
+        template<typename... Args>
+        struct assert_stages : public assert_signature_args<Args...>
+        {
+        };
+
+        template<typename T>
+        struct assert_stages<T> : public assert_consumer<T>
+        {
+        };
+
     } // internal
 } // jstd
@@ -34,6 +34,9 @@ namespace jstd
     template<typename Target_type, typename Enable = void>
     class conveyor_forwarder;
 
+    template<typename T>
+    class static_forwarder;
+
     /**
      * @addtogroup concurrency
      * @{
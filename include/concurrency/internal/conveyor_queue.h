@@ -0,0 +1,283 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../conveyor_flush.h"
+#include "../conveyor_options.h"
+#include "../conveyor_statistics.h"
+#include "../recycler.h"
+#include "../blocking_queue.h"
+#include "../mpmc_queue.h"
+#include "../mpsc_queue.h"
+#include "../spsc_queue.h"
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Queue of a conveyor, that is allocated on the NUMA node of the options. Queues that allocate their
+        // storage while they are used cannot be placed, a node is rejected for them instead of being ignored.
+        template <typename Queue, bool = Queue::numa_placement>
+        class placed_queue : public Queue
+        {
+        public:
+            explicit placed_queue(const conveyor_options& options)
+                : Queue(options.capacity, options.numa_node)
+            {
+            }
+        };
+
+        template <typename Queue>
+        class placed_queue<Queue, false> : public Queue
+        {
+        public:
+            explicit placed_queue(const conveyor_options& options)
+                : Queue(capacity(options))
+            {
+            }
+
+        private:
+            static std::size_t capacity(const conveyor_options& options)
+            {
+                if (options.numa_node >= 0)
+                    throw std::invalid_argument("The queue of the conveyor cannot be placed on a NUMA node.");
+
+                return options.capacity;
+            }
+        };
+
+        // Push interface that all conveyors share. The derived conveyor consumes the queue on its own threads and
+        // closes it before they are joined.
+        template <typename ForwardType, typename Queue, typename Statistics, typename Flush>
+        class conveyor_queue
+        {
+            static_assert(std::is_move_constructible<ForwardType>::value,
+                          "The template parameter is not move constructable. "
+                          "If this type cannot be made move constructable use std::unique_ptr<T>.");
+
+            static_assert(std::is_same<typename Queue::value_type, ForwardType>::value,
+                          "The value type of the queue does not match the forwarded type.");
+
+        public:
+            conveyor_queue(const conveyor_queue&) = delete;
+            conveyor_queue& operator=(const conveyor_queue&) = delete;
+
+            /**
+             * @brief Pushes a value to the processor and waits for free space, if the queue is full.
+             */
+            void push(ForwardType&& forwardValue)
+            {
+                counted([&] { return queue_.push(Statistics::stamp(std::move(forwardValue))); });
+            }
+
+            template <typename T = ForwardType>
+            void push(const T& forwardValue,
+                      typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+            {
+                counted([&] { return queue_.push(Statistics::stamp(forwardValue)); });
+            }
+
+            /**
+             * @brief Constructs a value in place in the queue and waits for free space, if the queue is full.
+             *
+             * This saves the moves of a pushed value. Queues that consume in place pass the processor a reference
+             * to the queued value, so it is not moved at all.
+             */
+            template <typename... Args>
+            void emplace(Args&&... args)
+            {
+                counted([&] { return Statistics::emplace(queue_, std::forward<Args>(args)...); });
+            }
+
+            /**
+             * @brief Pushes a value to the processor, if the queue is not full.
+             * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+             */
+            bool try_push(ForwardType&& forwardValue)
+            {
+                return counted([&] { return queue_.try_push(Statistics::stamp(std::move(forwardValue))); });
+            }
+
+            template <typename T = ForwardType>
+            bool try_push(const T& forwardValue,
+                          typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+            {
+                return counted([&] { return queue_.try_push(Statistics::stamp(forwardValue)); });
+            }
+
+            /**
+             * @brief Pushes a value to the processor and waits at most for the given duration for free space,
+             * if the queue is full.
+             * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+             */
+            template <typename Rep, typename Period>
+            bool push_for(ForwardType&& forwardValue, const std::chrono::duration<Rep, Period>& timeout)
+            {
+                return push_until(std::move(forwardValue), std::chrono::steady_clock::now() + timeout);
+            }
+
+            template <typename Rep, typename Period, typename T = ForwardType>
+            bool push_for(const T& forwardValue, const std::chrono::duration<Rep, Period>& timeout,
+                          typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+            {
+                return push_until(forwardValue, std::chrono::steady_clock::now() + timeout);
+            }
+
+            /**
+             * @brief Pushes a value to the processor and waits at most until the deadline for free space,
+             * if the queue is full.
+             * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+             */
+            template <typename Clock, typename Duration>
+            bool push_until(ForwardType&& forwardValue, const std::chrono::time_point<Clock, Duration>& deadline)
+            {
+                return counted([&] { return queue_.push_until(Statistics::stamp(std::move(forwardValue)), deadline); });
+            }
+
+            template <typename Clock, typename Duration, typename T = ForwardType>
+            bool push_until(const T& forwardValue, const std::chrono::time_point<Clock, Duration>& deadline,
+                            typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+            {
+                return counted([&] { return queue_.push_until(Statistics::stamp(forwardValue), deadline); });
+            }
+
+            /**
+             * @brief Returns a value that has been processed before for reuse, or a default constructed value.
+             *
+             * Values are only recycled, if the conveyor has been created with a recycle_capacity.
+             */
+            ForwardType acquire()
+            {
+                return recycler_ ? recycler_->acquire() : ForwardType();
+            }
+
+            /**
+             * @brief Waits until all values that were pushed before have been processed.
+             *
+             * Unlike the destructor, the conveyor keeps running and can be pushed to while and after it is flushed.
+             * Values that other threads push meanwhile may be waited for as well. A batch that waits for its
+             * batch_delay is only passed, when the delay has expired. Once a processor has thrown, flush returns
+             * immediately. It must not be called by the processor itself.
+             *
+             * Only available, if the conveyor has been created with conveyor_flush as its flush policy.
+             */
+            void flush()
+            {
+                flush_async().wait();
+            }
+
+            /**
+             * @brief Returns a future that becomes ready, once all values that were pushed before have been processed.
+             * @see flush
+             */
+            std::future<void> flush_async()
+            {
+                static_assert(Flush::enabled,
+                              "The conveyor does not support flush. Use conveyor_flush as its flush policy.");
+
+                return barrier_.flush_async();
+            }
+
+            /**
+             * @brief Returns a snapshot of the statistics of the conveyor.
+             *
+             * Only available, if the conveyor measures its statistics with conveyor_statistics.
+             */
+            conveyor_stats stats() const
+            {
+                static_assert(Statistics::enabled,
+                              "The conveyor does not measure statistics. Use conveyor_statistics as its policy.");
+
+                return statistics_.snapshot();
+            }
+
+        protected:
+            using stored_type = typename Statistics::template queue_type<Queue>::value_type;
+
+            conveyor_queue(const conveyor_options& options, std::size_t threads)
+                : queue_(options)
+                , statistics_(threads)
+                , barrier_(threads)
+                , recycler_(options.recycle_capacity == 0
+                                    ? nullptr
+                                    : std::make_unique<recycler<ForwardType> >(options.recycle_capacity))
+            {
+            }
+
+            ~conveyor_queue() = default;
+
+            // Keeps a processed value for acquire, if recycling is enabled.
+            void recycle(ForwardType& value)
+            {
+                if (recycler_)
+                    recycler_->release(std::move(value));
+            }
+
+        private:
+            // The value is counted before it is queued, so that it cannot be processed uncounted.
+            template <typename Push>
+            bool counted(Push&& push)
+            {
+                barrier_.pushing();
+                statistics_.pushing();
+
+                auto pushed = false;
+
+                try
+                {
+                    pushed = push();
+                }
+                catch (...)
+                {
+                    statistics_.rejected();
+                    barrier_.rejected();
+                    throw;
+                }
+
+                if (!pushed)
+                {
+                    statistics_.rejected();
+                    barrier_.rejected();
+                }
+
+                return pushed;
+            }
+
+        protected:
+            placed_queue<typename Statistics::template queue_type<Queue> > queue_;
+            Statistics statistics_;
+            Flush barrier_;
+
+        private:
+            const std::unique_ptr<recycler<ForwardType> > recycler_;
+        };
+
+    } // internal
+
+} // jstd
@@ -22,7 +22,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <cstddef>
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 #include "../../type_traits/function_traits.h"
 #include "conveyor_forwarder.h"
@@ -90,6 +93,14 @@ namespace jstd
             using target_type = TargetType;
         };
 
+        template <typename TargetType>
+        struct callable_type_impl<void(static_forwarder<TargetType>&)>
+                : public callable_type_impl<void(conveyor_forwarder<TargetType>&)> {};
+
+        template <typename SourceType, typename TargetType>
+        struct callable_type_impl<void(SourceType&&, static_forwarder<TargetType>&)>
+                : public callable_type_impl<void(SourceType&&, conveyor_forwarder<TargetType>&)> {};
+
         template <typename SourceType>
         struct callable_type_impl<void(SourceType&&)>
         {
@@ -99,6 +110,20 @@ namespace jstd
             using target_type = void;
         };
 
+        // Converter or consumer of conveyor_function that runs on multiple threads, created by jstd::parallel.
+        template <typename CallableType>
+        struct parallel_stage
+        {
+            std::size_t replicas;
+            CallableType callable;
+        };
+
+        template <typename T>
+        struct is_parallel_stage : public std::false_type {};
+
+        template <typename T>
+        struct is_parallel_stage<parallel_stage<T> > : public std::true_type {};
+
         template <typename T, typename = void>
         struct callable_type : public no_callable_type {};
 
@@ -106,6 +131,117 @@ namespace jstd
         struct callable_type<T, typename std::enable_if<is_callable<T>::value>::type >
                 : public callable_type_impl<T> {};
 
+        // A parallel stage has the signature of the callable it wraps.
+        template <typename T>
+        struct callable_type<T, typename std::enable_if<is_parallel_stage<typename std::decay<T>::type>::value>::type>
+                : public callable_type<decltype(std::declval<typename std::decay<T>::type>().callable)> {};
+
+        // Unwraps the callable of a stage, that is passed to conveyor_function.
+        template <typename T>
+        struct stage_type
+        {
+            using callable_type = T;
+
+            static T&& callable(T&& stage)
+            {
+                return std::forward<T>(stage);
+            }
+        };
+
+        template <typename T>
+        struct stage_type<parallel_stage<T> >
+        {
+            using callable_type = T;
+
+            static T&& callable(parallel_stage<T>&& stage)
+            {
+                return std::move(stage.callable);
+            }
+        };
+
+        template <typename T>
+        struct stage_type<parallel_stage<T>&>
+        {
+            using callable_type = T&;
+
+            static T& callable(parallel_stage<T>& stage)
+            {
+                return stage.callable;
+            }
+        };
+
+        template <typename T>
+        struct stage_type<const parallel_stage<T>&>
+        {
+            using callable_type = const T&;
+
+            static const T& callable(const parallel_stage<T>& stage)
+            {
+                return stage.callable;
+            }
+        };
+
+        // A moved const stage cannot give up its callable, so the callable is copied.
+        template <typename T>
+        struct stage_type<const parallel_stage<T> >
+        {
+            using callable_type = T;
+
+            static T callable(const parallel_stage<T>&& stage)
+            {
+                return stage.callable;
+            }
+        };
+
+        template <typename T>
+        std::size_t stage_replicas(const T&)
+        {
+            return 1;
+        }
+
+        template <typename T>
+        std::size_t stage_replicas(const parallel_stage<T>& stage)
+        {
+            return stage.replicas == 0 ? 1 : stage.replicas;
+        }
+
+        // Creates a stage per callable, the last one first, so that each converter pushes to the forwarder of the
+        // stage after it. A Stage is constructed from its callable, the context and its number of replicas and is
+        // linked to the next stage by setNext.
+        template <template <typename, typename> class Stage, typename Context, typename T,
+                  typename SourceType = typename callable_type<T>::source_type,
+                  typename StageType = Stage<SourceType, typename stage_type<T>::callable_type> >
+        std::unique_ptr<StageType> make_stages(const Context& context, T&& consumer)
+        {
+            const auto replicas = stage_replicas(consumer);
+
+            return std::make_unique<StageType>(stage_type<T>::callable(std::forward<T>(consumer)), context, replicas);
+        }
+
+        template <template <typename, typename> class Stage, typename Context, typename T, typename... Args,
+                  typename SourceType = typename callable_type<T>::source_type,
+                  typename std::enable_if<callable_type<T>::callable == Callable::converter, int>::type = 0>
+        auto make_stages(const Context& context, T&& converter, Args&&... args)
+        {
+            auto&& next = make_stages<Stage>(context, std::forward<Args>(args)...);
+            auto& forwarder = next->forwarder();
+
+            // The replicas of a parallel converter push to the same forwarder.
+            const auto replicas = stage_replicas(converter);
+
+            auto&& consumer = [&forwarder, cv = stage_type<T>::callable(std::forward<T>(converter))](SourceType&& value)
+            {
+                cv(std::move(value), forwarder);
+            };
+
+            using ConsumerType = typename std::decay<decltype(consumer)>::type;
+
+            auto&& stage = std::make_unique<Stage<SourceType, ConsumerType> >(std::move(consumer), context, replicas);
+            stage->setNext(std::move(next));
+
+            return std::move(stage);
+        }
+
 
 
 
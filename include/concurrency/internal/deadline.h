@@ -0,0 +1,79 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Deadline of an operation that waits as long as it takes.
+        struct no_deadline {};
+
+        template <typename Predicate>
+        bool wait_until(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                        no_deadline, Predicate&& predicate)
+        {
+            cv.wait(lock, std::forward<Predicate>(predicate));
+            return true;
+        }
+
+        // Deadline of an operation that must not wait at all.
+        struct no_wait {};
+
+        template <typename Predicate>
+        bool wait_until(std::condition_variable&, std::unique_lock<std::mutex>&,
+                        no_wait, Predicate&& predicate)
+        {
+            return predicate();
+        }
+
+        template <typename Clock, typename Duration, typename Predicate>
+        bool wait_until(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                        const std::chrono::time_point<Clock, Duration>& deadline, Predicate&& predicate)
+        {
+            return cv.wait_until(lock, deadline, std::forward<Predicate>(predicate));
+        }
+
+        inline bool expired(no_deadline)
+        {
+            return false;
+        }
+
+        inline bool expired(no_wait)
+        {
+            return true;
+        }
+
+        template <typename Clock, typename Duration>
+        bool expired(const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return Clock::now() >= deadline;
+        }
+
+    } // internal
+
+} // jstd
@@ -0,0 +1,188 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "cache_line.h"
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Lets a flush wait for the values that were pushed before it, while the conveyor keeps running.
+        //
+        // Producers count a value before they queue it and take the count back, if the push fails, so the number
+        // of pushed values never lags behind the queue. The processor threads count the values they have
+        // processed. With a single processor thread, the values are processed in the order they were queued, so
+        // the flush is done once as many values have been processed as had been pushed before.
+        //
+        // Multiple processor threads finish the values out of order. Therefore each of them publishes the number
+        // of processed values before it takes its next value. That value has been queued after at least as many
+        // values, so no value that was queued before it can still be waiting or in progress once all threads
+        // have published a number beyond the pushed values of the flush. A thread that waits for an empty queue
+        // cannot publish a new number, but then the conveyor is idle and all pushed values have been processed.
+        class flush_barrier
+        {
+            struct processor_bound
+            {
+                std::atomic<std::uint64_t> processed { 0 };
+
+                char padding_[internal::cache_line_size];
+            };
+
+            struct request
+            {
+                std::uint64_t pushed;
+                std::promise<void> done;
+            };
+
+        public:
+            static const bool enabled = true;
+
+            explicit flush_barrier(std::size_t threads)
+                : threads_(threads == 0 ? 1 : threads)
+                , bounds_(new processor_bound[threads_])
+            {
+            }
+
+            flush_barrier(const flush_barrier&) = delete;
+            flush_barrier& operator=(const flush_barrier&) = delete;
+
+            void pushing()
+            {
+                pushed_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void rejected()
+            {
+                pushed_.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            // Called by a processor thread after it has finished the given number of values and before it takes
+            // its next value.
+            void processed(std::size_t thread, std::size_t count)
+            {
+                const auto processed = processed_.fetch_add(count) + count;
+                bounds_[thread].processed.store(processed);
+
+                // Either this thread sees the waiting flush, or the flush sees the published number.
+                if (waiting_.load())
+                    complete();
+            }
+
+            std::future<void> flush_async()
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                requests_.push_back(request { pushed_.load(), std::promise<void>() });
+                auto done = requests_.back().done.get_future();
+
+                waiting_.store(true);
+                completeLocked();
+
+                return done;
+            }
+
+            // Completes all current and future flushes, when the processor threads have stopped.
+            void stop()
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                stopped_ = true;
+                completeLocked();
+            }
+
+        private:
+            bool reached(std::uint64_t pushed) const
+            {
+                // Read first, so that the values pushed meanwhile do not let the conveyor appear to be idle.
+                const auto processed = processed_.load();
+                const auto current = pushed_.load();
+
+                if (processed == current)
+                    return true;
+
+                // The pushed values of the flush also count failed pushes, that have not been taken back yet.
+                const auto target = std::min(pushed, current);
+
+                if (processed < target)
+                    return false;
+
+                for (auto thread = std::size_t(0); thread < threads_; ++thread)
+                {
+                    if (bounds_[thread].processed.load() < target)
+                        return false;
+                }
+
+                return true;
+            }
+
+            void complete()
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                completeLocked();
+            }
+
+            void completeLocked()
+            {
+                for (auto current = requests_.begin(); current != requests_.end();)
+                {
+                    if (stopped_ || reached(current->pushed))
+                    {
+                        current->done.set_value();
+                        current = requests_.erase(current);
+                    }
+                    else
+                        ++current;
+                }
+
+                waiting_.store(!requests_.empty());
+            }
+
+        private:
+            const std::size_t threads_;
+            const std::unique_ptr<processor_bound[]> bounds_;
+
+            std::atomic<std::uint64_t> pushed_ { 0 };
+
+            char padding_[internal::cache_line_size];
+
+            std::atomic<std::uint64_t> processed_ { 0 };
+            std::atomic<bool> waiting_ { false };
+
+            std::mutex guard_;
+            std::vector<request> requests_;
+            bool stopped_ = false;
+        };
+
+    } // internal
+
+} // jstd
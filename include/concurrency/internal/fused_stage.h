@@ -0,0 +1,228 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "conveyor_assertions.h"
+#include "conveyor_forwarder.h"
+#include "conveyor_traits.h"
+#include "stage_queue.h"
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Forwards the values of a first fused callable, that takes a conveyor_forwarder reference, by calling the
+        // second one directly. As the class is final, its push is devirtualized, once the first callable has been
+        // inlined into the fused stage.
+        template<typename MiddleType, typename Second, typename... Forwarder>
+        class fused_forwarder final : public conveyor_forwarder<MiddleType>
+        {
+        public:
+            fused_forwarder(const Second& second, Forwarder&... forwarder)
+                    : second_(second)
+                      , forwarder_(forwarder...)
+            {
+            }
+
+            void push(MiddleType&& value) override
+            {
+                call(std::move(value), std::index_sequence_for<Forwarder...>());
+            }
+
+        private:
+            template<std::size_t... I>
+            void call(MiddleType&& value, std::index_sequence<I...>)
+            {
+                second_(std::move(value), std::get<I>(forwarder_)...);
+            }
+
+            const Second& second_;
+            std::tuple<Forwarder&...> forwarder_;
+        };
+
+        // Values that a first fused callable pushes to its static_forwarder, until they are passed on.
+        template<typename T>
+        struct fused_buffer
+        {
+            fused_buffer()
+                    : queue(values)
+                      , forwarder(queue)
+            {
+            }
+
+            std::vector<T> values;
+            stage_queue<T> queue;
+            static_forwarder<T> forwarder;
+        };
+
+        template<typename First, typename Second>
+        class fused_stage_base
+        {
+        protected:
+            using source_type = typename callable_type<First>::source_type;
+            using middle_type = typename callable_type<First>::target_type;
+
+            fused_stage_base(First&& first, Second&& second)
+                    : first_(std::forward<First>(first))
+                      , second_(std::forward<Second>(second))
+            {
+                assert_fusible<First, Second>();
+                static_assert(!is_parallel_stage<std::decay_t<First> >::value &&
+                              !is_parallel_stage<std::decay_t<Second> >::value,
+                              "A parallel stage can not be fused, but fused callables can run in parallel.");
+            }
+
+            // The middle forwarder is chosen by the type that the first callable takes.
+            template<typename... Forwarder>
+            void call(source_type&& value, Forwarder&... forwarder) const
+            {
+                call(takes_conveyor_forwarder<First>(), std::move(value), forwarder...);
+            }
+
+        private:
+            template<typename... Forwarder>
+            void call(std::true_type, source_type&& value, Forwarder&... forwarder) const
+            {
+                fused_forwarder<middle_type, std::decay_t<Second>, Forwarder...> middle(second_, forwarder...);
+
+                first_(std::move(value), middle);
+            }
+
+            // A static_forwarder only pushes to a stage queue, so the values of the first callable are buffered and
+            // passed to the second callable, once the first one has returned. Neither of them is called through a
+            // virtual function.
+            template<typename... Forwarder>
+            void call(std::false_type, source_type&& value, Forwarder&... forwarder) const
+            {
+                // A fused stage cannot be nested into a fused stage of its own type, so the buffer of the thread is
+                // empty, when the call starts.
+                static thread_local fused_buffer<middle_type> buffer;
+
+                // The values that were forwarded before the first callable threw are still passed on, like
+                // without fusion.
+                try
+                {
+                    first_(std::move(value), buffer.forwarder);
+                }
+                catch (...)
+                {
+                    passOn(buffer.values, forwarder...);
+                    throw;
+                }
+
+                passOn(buffer.values, forwarder...);
+            }
+
+            template<typename... Forwarder>
+            void passOn(std::vector<middle_type>& values, Forwarder&... forwarder) const
+            {
+                // The values after one that the second callable threw on are dropped, like their pushes would have
+                // been skipped without buffering.
+                try
+                {
+                    for (auto& value : values)
+                        second_(std::move(value), forwarder...);
+                }
+                catch (...)
+                {
+                    values.clear();
+                    throw;
+                }
+
+                values.clear();
+            }
+
+            std::decay_t<First> first_;
+            std::decay_t<Second> second_;
+        };
+
+        template<typename First, typename Second, typename = void>
+        class fused_stage;
+
+        // A converter fused with a converter is a converter. The forwarder of the stage is passed on to the second
+        // callable as it is, so that it keeps the type that the second callable takes.
+        template<typename First, typename Second>
+        class fused_stage<First, Second,
+                          typename std::enable_if<callable_type<Second>::callable == Callable::converter>::type>
+                : private fused_stage_base<First, Second>
+        {
+            using base = fused_stage_base<First, Second>;
+
+        public:
+            using source_type = typename base::source_type;
+            using target_type = typename callable_type<Second>::target_type;
+
+            fused_stage(First&& first, Second&& second)
+                    : base(std::forward<First>(first), std::forward<Second>(second))
+            {
+            }
+
+            template<typename Forwarder>
+            void operator()(source_type&& value, Forwarder& forwarder) const
+            {
+                base::call(std::move(value), forwarder);
+            }
+        };
+
+        // A converter fused with a consumer is a consumer.
+        template<typename First, typename Second>
+        class fused_stage<First, Second,
+                          typename std::enable_if<callable_type<Second>::callable == Callable::consumer>::type>
+                : private fused_stage_base<First, Second>
+        {
+            using base = fused_stage_base<First, Second>;
+
+        public:
+            fused_stage(First&& first, Second&& second)
+                    : base(std::forward<First>(first), std::forward<Second>(second))
+            {
+            }
+
+            void operator()(typename base::source_type&& value) const
+            {
+                base::call(std::move(value));
+            }
+        };
+
+        template<typename T>
+        struct is_fused_converter : public std::false_type {};
+
+        template<typename First, typename Second>
+        struct is_fused_converter<fused_stage<First, Second> >
+                : public std::integral_constant<bool, callable_type<Second>::callable == Callable::converter> {};
+
+        // The call operator of a fused converter is a template on the forwarder, so its signature is taken from the
+        // fused callables.
+        template<typename T>
+        struct callable_type<T, typename std::enable_if<is_fused_converter<std::decay_t<T> >::value>::type>
+                : public callable_type_impl<void(typename std::decay_t<T>::source_type&&,
+                                                 conveyor_forwarder<typename std::decay_t<T>::target_type>&)> {};
+
+    } // internal
+} // jstd
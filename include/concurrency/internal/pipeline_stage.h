@@ -0,0 +1,148 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "../conveyor_options.h"
+#include "conveyor_traits.h"
+#include "stage_queue.h"
+
+namespace jstd
+{
+    namespace internal
+    {
+        class pipeline_stage_proxy
+        {
+        public:
+            virtual ~pipeline_stage_proxy() = default;
+
+            virtual void close() = 0;
+        };
+
+        // Passed to each stage of a pipeline on construction.
+        struct pipeline_context
+        {
+            pipeline_state& state;
+            const conveyor_options& options;
+        };
+
+        // Stage of a pipeline, whose threads keep running until the stage is closed. Unlike internal::conveyor
+        // an exception of the callable does not stop the stage, it is only recorded for the next flush.
+        template<typename T, typename Callable>
+        class pipeline_stage : public pipeline_stage_proxy
+        {
+        public:
+            pipeline_stage(Callable&& callable, const pipeline_context& context, std::size_t replicas)
+                    : callable_(std::forward<Callable>(callable))
+                      , state_(context.state)
+                      , input_(context.options.capacity, &context.state)
+                      , forwarder_(input_)
+            {
+                try
+                {
+                    const auto shared = replicas > 1;
+
+                    do
+                        handles_.push_back(launch(context.options, [this, shared] { run(shared); }));
+                    while (handles_.size() < replicas);
+                }
+                catch (...)
+                {
+                    wait();
+                    throw;
+                }
+            }
+
+            ~pipeline_stage() override
+            {
+                wait();
+            }
+
+            void close() override
+            {
+                wait();
+
+                if (next_)
+                    next_->close();
+            }
+
+            static_forwarder<T>& forwarder()
+            {
+                return forwarder_;
+            }
+
+            void setNext(std::unique_ptr<pipeline_stage_proxy>&& next)
+            {
+                next_ = std::move(next);
+            }
+
+        private:
+            void wait()
+            {
+                input_.queue().close();
+
+                for (auto& handle : handles_)
+                    if (handle.valid())
+                        handle.wait();
+            }
+
+            void run(bool shared)
+            {
+                const auto consume = [this](T&& value)
+                {
+                    try
+                    {
+                        callable_(std::move(value));
+                    }
+                    catch (...)
+                    {
+                        state_.failed(std::current_exception());
+                    }
+
+                    state_.processed();
+                };
+
+                // Only a single consumer may drain the queue at once.
+                if (shared)
+                    while (input_.queue().pop(consume));
+                else
+                    while (input_.queue().pop_all(consume));
+            }
+
+            Callable callable_;
+            pipeline_state& state_;
+
+            stage_queue<T> input_;
+            static_forwarder<T> forwarder_;
+            std::vector<std::future<void> > handles_;
+
+            std::unique_ptr<pipeline_stage_proxy> next_;
+        };
+
+    } // internal
+} // jstd
@@ -0,0 +1,228 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../blocking_queue.h"
+#include "conveyor_forwarder.h"
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Counts the values that are queued or processed in any stage of a pipeline. A converter forwards its values
+        // before its own value is counted as processed, so the count only drops to zero once all stages are idle.
+        class pipeline_state
+        {
+        public:
+            void pushed()
+            {
+                ++pending_;
+            }
+
+            void processed()
+            {
+                if (--pending_ != 0)
+                    return;
+
+                {
+                    std::lock_guard<std::mutex> lock(guard_);
+                }
+
+                idle_.notify_all();
+            }
+
+            void failed(std::exception_ptr error)
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                if (!error_)
+                    error_ = std::move(error);
+            }
+
+            void wait()
+            {
+                std::unique_lock<std::mutex> lock(guard_);
+
+                idle_.wait(lock, [this] { return pending_ == 0; });
+            }
+
+            std::exception_ptr takeError()
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+
+                auto error = std::move(error_);
+                error_ = nullptr;
+
+                return error;
+            }
+
+        private:
+            std::atomic<std::size_t> pending_ { 0 };
+
+            std::mutex guard_;
+            std::condition_variable idle_;
+            std::exception_ptr error_;
+        };
+
+        // Input queue of a stage of conveyor_function or pipeline. The previous stage pushes to it directly through
+        // a static_forwarder. An error of the stage closes the queue and is rethrown to the pushing stage.
+        template<typename T>
+        class stage_queue
+        {
+        public:
+            explicit stage_queue(std::size_t capacity = 0, pipeline_state* state = nullptr)
+                    : queue_(capacity)
+                      , state_(state)
+            {
+            }
+
+            // Collects the pushed values in the buffer instead, for a fused stage that passes them on by itself.
+            explicit stage_queue(std::vector<T>& buffer)
+                    : queue_(0)
+                      , state_(nullptr)
+                      , buffer_(&buffer)
+            {
+            }
+
+            template<typename U>
+            void push(U&& value)
+            {
+                if (buffer_)
+                {
+                    buffer_->push_back(std::forward<U>(value));
+                    return;
+                }
+
+                checkForError();
+
+                if (state_)
+                    state_->pushed();
+
+                // The queue is only closed early, if the stage failed or has been closed.
+                if (!queue_.push(std::forward<U>(value)))
+                {
+                    if (state_)
+                        state_->processed();
+
+                    checkForError();
+                }
+            }
+
+            void fail(std::exception_ptr error)
+            {
+                // Only the first error of the replicas is kept.
+                if (!failed_.exchange(true))
+                {
+                    error_ = std::move(error);
+                    hasError_ = true;
+                }
+
+                // Releases a producer that waits for free space in a full queue.
+                queue_.close();
+            }
+
+            void checkForError() const
+            {
+                if (hasError_)
+                    std::rethrow_exception(error_);
+            }
+
+            blocking_queue<T>& queue()
+            {
+                return queue_;
+            }
+
+        private:
+            blocking_queue<T> queue_;
+            pipeline_state* state_;
+            std::vector<T>* buffer_ = nullptr;
+
+            std::exception_ptr error_;
+            std::atomic<bool> failed_ { false };
+            std::atomic<bool> hasError_ { false };
+        };
+
+    } // internal
+
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Forwarder that conveyor_function and pipeline pass to their producers and converters.
+     *
+     * As the class is final, a push on a static_forwarder reference is a direct call to the queue of the following
+     * callable, which the compiler can inline. Callables that take a conveyor_forwarder reference instead keep
+     * working, but pay for a virtual call per value.
+     *
+     * @code
+     * jstd::conveyor_function([](jstd::static_forwarder<std::string>& forwarder) { ... },
+     *                         [](std::string&& line, jstd::static_forwarder<record>& forwarder) { ... },
+     *                         [](record&& value) { ... });
+     * @endcode
+     *
+     * @tparam T The type of the data that is forwarded to the next callable.
+     */
+    template<typename T>
+    class static_forwarder final : public conveyor_forwarder<T>
+    {
+    public:
+        explicit static_forwarder(internal::stage_queue<T>& queue)
+                : queue_(queue)
+        {
+        }
+
+        /**
+         * @brief Pushes a value to the following callable.
+         */
+        void push(T&& forwardValue) override
+        {
+            queue_.push(std::move(forwardValue));
+        }
+
+        /**
+         * @brief Pushes a copy of the value to the following callable.
+         */
+        template<typename U = T, typename std::enable_if<std::is_copy_constructible<U>::value, int>::type = 0>
+        void push(const T& forwardValue)
+        {
+            queue_.push(forwardValue);
+        }
+
+    private:
+        internal::stage_queue<T>& queue_;
+    };
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,468 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <new>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+#include "internal/affinity.h"
+#include "internal/cache_line.h"
+#include "internal/deadline.h"
+#include "wait_strategy.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Lock-free bounded ring buffer for any number of producer and consumer threads.
+     *
+     * Every slot carries a sequence number, that tells producers and consumers whether the slot is free or filled
+     * for the current round. Producers and consumers claim slots by a compare and swap of their own index, so they
+     * only contend with their own kind. The mutex and the condition variables are only used to park consumers
+     * while the queue is empty or producers while the queue is full.
+     *
+     * @tparam T Type of the queued values.
+     * @tparam WaitStrategy Decides how a consumer waits for the next value, e.g. park_wait, spin_wait or busy_wait.
+     */
+    template <typename T, typename WaitStrategy = park_wait>
+    class mpmc_queue
+    {
+        struct cell
+        {
+            explicit cell(std::size_t sequence)
+                : sequence(sequence)
+            {
+            }
+
+            std::atomic<std::size_t> sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+
+            T& get()
+            {
+                return reinterpret_cast<T&>(value);
+            }
+        };
+
+    public:
+        using value_type = T;
+
+        static const bool multi_consumer = true;
+        static const bool numa_placement = true;
+        static const std::size_t default_capacity = 1024;
+
+    public:
+        /**
+         * @param capacity Maximum number of queued values. The capacity is rounded up to the next power of two.
+         * Zero selects the default capacity.
+         * @param node NUMA node the ring is allocated on, see conveyor_options::numa_node. A negative node allocates
+         * the ring from the heap.
+         */
+        explicit mpmc_queue(std::size_t capacity = default_capacity, int node = -1)
+            : mask_(toMask(capacity == 0 ? default_capacity : capacity))
+            , ring_((mask_ + 1) * sizeof(cell), node)
+            , cells_(static_cast<cell*>(ring_.get()))
+        {
+            // The cells are first touched here, on the node of the ring.
+            for (auto i = std::size_t(0); i <= mask_; ++i)
+                new (&cells_[i]) cell(i);
+        }
+
+        mpmc_queue(const mpmc_queue&) = delete;
+        mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+        ~mpmc_queue()
+        {
+            const auto tail = enqueuePosition_.load(std::memory_order_relaxed);
+
+            for (auto head = dequeuePosition_.load(std::memory_order_relaxed); head != tail; ++head)
+                cells_[head & mask_].get().~T();
+        }
+
+        std::size_t capacity() const
+        {
+            return mask_ + 1;
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool push(U&& value)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Constructs a value in place at the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not constructed.
+         */
+        template <typename... Args>
+        bool emplace(Args&&... args)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue, if the queue is not full.
+         * @return false, if the queue is full or has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool try_push(U&& value)
+        {
+            return pushInternal(internal::no_wait(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits until the deadline for free space,
+         * if the queue is full.
+         * @return false, if the deadline expired or the queue has been closed and the value was not queued.
+         */
+        template <typename U, typename Clock, typename Duration>
+        bool push_until(U&& value, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return pushInternal(deadline, std::forward<U>(value));
+        }
+
+        /**
+         * @brief Waits for the next value and passes it as rvalue reference to the consumer.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop(Consumer&& consumer)
+        {
+            auto position = std::size_t(0);
+            auto current = static_cast<cell*>(nullptr);
+
+            while (!(current = claimFilled(position)))
+            {
+                if (!waitNotEmpty(internal::no_deadline()))
+                    return false;
+            }
+
+            consume(current, position, consumer);
+
+            return true;
+        }
+
+        /**
+         * @brief Passes the next value as rvalue reference to the consumer, if the queue is not empty.
+         * @return false, if the queue is empty and the consumer was not called.
+         */
+        template <typename Consumer>
+        bool try_pop(Consumer&& consumer)
+        {
+            auto position = std::size_t(0);
+            const auto current = claimFilled(position);
+
+            if (!current)
+                return false;
+
+            consume(current, position, consumer);
+
+            return true;
+        }
+
+        /**
+         * @brief Waits for the next value and passes all queued values one after another as rvalue references
+         * to the consumer.
+         *
+         * Other consumers may take values from the queue at the same time.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop_all(Consumer&& consumer)
+        {
+            return popAllInternal(consumer, internal::no_deadline());
+        }
+
+        /**
+         * @brief Waits until the deadline for the next value and passes all queued values one after another as
+         * rvalue references to the consumer.
+         * @return false, if the queue has been closed and all values have been consumed. true without consuming
+         * any value, if the deadline expired.
+         */
+        template <typename Consumer, typename Clock, typename Duration>
+        bool pop_all_until(Consumer&& consumer, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return popAllInternal(consumer, deadline);
+        }
+
+        /**
+         * @brief Rejects all further values and wakes up all waiting producers and consumers.
+         *
+         * Values that were queued before are still passed to the consumers.
+         */
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                closed_.store(true, std::memory_order_release);
+            }
+
+            notEmpty_.notify_all();
+            notFull_.notify_all();
+        }
+
+    private:
+        static std::size_t toMask(std::size_t capacity)
+        {
+            return internal::round_up_to_power_of_two(capacity < 2 ? 2 : capacity) - 1;
+        }
+
+        template <typename Consumer, typename Deadline>
+        bool popAllInternal(Consumer& consumer, const Deadline& deadline)
+        {
+            auto position = std::size_t(0);
+            auto current = static_cast<cell*>(nullptr);
+
+            while (!(current = claimFilled(position)))
+            {
+                if (!waitNotEmpty(deadline))
+                {
+                    // Either the deadline expired or the queue has been closed. Values pushed before the queue was
+                    // closed are left for the next call.
+                    return !closed_.load(std::memory_order_acquire) || isFilled();
+                }
+            }
+
+            consume(current, position, consumer);
+
+            for (auto count = mask_; count != 0; --count)
+            {
+                current = claimFilled(position);
+
+                if (!current)
+                    break;
+
+                consume(current, position, consumer);
+            }
+
+            return true;
+        }
+
+        // Moves the value out of the claimed cell and passes the cell back to the producers before the value is
+        // consumed.
+        template <typename Consumer>
+        void consume(cell* current, std::size_t position, Consumer& consumer)
+        {
+            auto value = std::move(current->get());
+            current->get().~T();
+            current->sequence.store(position + mask_ + 1, std::memory_order_release);
+
+            notify(waitingProducers_, notFull_);
+
+            consumer(std::move(value));
+        }
+
+        // Returns the claimed free cell or nullptr, if the queue is full.
+        cell* claimFree(std::size_t& position)
+        {
+            position = enqueuePosition_.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                auto& current = cells_[position & mask_];
+                const auto sequence = current.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+                if (difference == 0)
+                {
+                    if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        return &current;
+                }
+                else if (difference < 0)
+                    return nullptr;
+                else
+                    position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Returns the claimed filled cell or nullptr, if the queue is empty.
+        cell* claimFilled(std::size_t& position)
+        {
+            position = dequeuePosition_.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                auto& current = cells_[position & mask_];
+                const auto sequence = current.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+                if (difference == 0)
+                {
+                    if (dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        return &current;
+                }
+                else if (difference < 0)
+                    return nullptr;
+                else
+                    position = dequeuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool isFilled() const
+        {
+            const auto position = dequeuePosition_.load(std::memory_order_relaxed);
+            return cells_[position & mask_].sequence.load(std::memory_order_acquire) == position + 1;
+        }
+
+        bool isFree() const
+        {
+            const auto position = enqueuePosition_.load(std::memory_order_relaxed);
+            return cells_[position & mask_].sequence.load(std::memory_order_acquire) == position;
+        }
+
+        template <typename Deadline, typename... Args>
+        bool pushInternal(const Deadline& deadline, Args&&... args)
+        {
+            auto position = std::size_t(0);
+            auto current = static_cast<cell*>(nullptr);
+
+            while (true)
+            {
+                if (closed_.load(std::memory_order_relaxed))
+                    return false;
+
+                if ((current = claimFree(position)))
+                    break;
+
+                if (!waitNotFull(deadline))
+                    return false;
+            }
+
+            new (&current->value) T(std::forward<Args>(args)...);
+            current->sequence.store(position + 1, std::memory_order_release);
+
+            notify(waitingConsumers_, notEmpty_);
+
+            return true;
+        }
+
+        // The waiting side counts itself before it checks the cells again, the other side publishes its cell
+        // before it checks the counter. The two fences guarantee that at least one of them sees the other's store.
+
+        void notify(std::atomic<std::size_t>& waiting, std::condition_variable& cv)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (waiting.load(std::memory_order_relaxed) != 0)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(guard_);
+                }
+
+                cv.notify_one();
+            }
+        }
+
+        template <typename Deadline>
+        bool waitNotEmpty(const Deadline& deadline)
+        {
+            // A spinning consumer does not synchronize with close() by the mutex. Once it has seen the flag, it
+            // checks the cells again, so that it cannot miss values that were pushed before the queue was closed.
+            const auto ready = [this] { return isFilled() || closed_.load(std::memory_order_acquire); };
+
+            if (!WaitStrategy::spin([&] { return ready() || internal::expired(deadline); }))
+            {
+                std::unique_lock<std::mutex> lock(guard_);
+
+                waitingConsumers_.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                internal::wait_until(notEmpty_, lock, deadline, ready);
+
+                waitingConsumers_.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            // Another consumer may claim the value before the caller does. An empty queue is only reported once
+            // it has been closed or the deadline expired, otherwise the caller tries to claim a value again.
+            const auto closed = closed_.load(std::memory_order_acquire);
+
+            if (isFilled())
+                return true;
+
+            return !closed && !internal::expired(deadline);
+        }
+
+        template <typename Deadline>
+        bool waitNotFull(const Deadline& deadline)
+        {
+            std::unique_lock<std::mutex> lock(guard_);
+
+            waitingProducers_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const auto hasSpace = internal::wait_until(notFull_, lock, deadline, [this]
+            {
+                return isFree() || closed_.load(std::memory_order_relaxed);
+            });
+
+            waitingProducers_.fetch_sub(1, std::memory_order_relaxed);
+
+            return hasSpace;
+        }
+
+    private:
+        const std::size_t mask_;
+        const internal::node_memory ring_;
+        cell* const cells_;
+
+        char padding0_[internal::cache_line_size];
+
+        std::atomic<std::size_t> dequeuePosition_ { 0 };
+
+        char padding1_[internal::cache_line_size];
+
+        std::atomic<std::size_t> enqueuePosition_ { 0 };
+
+        char padding2_[internal::cache_line_size];
+
+        std::atomic<bool> closed_ { false };
+        std::atomic<std::size_t> waitingConsumers_ { 0 };
+        std::atomic<std::size_t> waitingProducers_ { 0 };
+
+        std::mutex guard_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+    };
+
+    template <typename T, typename WaitStrategy>
+    const bool mpmc_queue<T, WaitStrategy>::multi_consumer;
+
+    template <typename T, typename WaitStrategy>
+    const bool mpmc_queue<T, WaitStrategy>::numa_placement;
+
+    template <typename T, typename WaitStrategy>
+    const std::size_t mpmc_queue<T, WaitStrategy>::default_capacity;
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,434 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+#include "internal/cache_line.h"
+#include "internal/deadline.h"
+#include "wait_strategy.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Lock-free linked list for any number of producer threads and exactly one consumer thread.
+     *
+     * A producer appends its value by a single atomic exchange of the tail pointer, so producers never wait for
+     * each other. The mutex and the condition variables are only used to park the consumer while the queue is empty
+     * or producers while a bounded queue is full.
+     *
+     * @tparam T Type of the queued values.
+     * @tparam WaitStrategy Decides how a consumer waits for the next value, e.g. park_wait, spin_wait or busy_wait.
+     * @warning Popping from more than one thread at a time is undefined.
+     */
+    template <typename T, typename WaitStrategy = park_wait>
+    class mpsc_queue
+    {
+        struct node
+        {
+            std::atomic<node*> next { nullptr };
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+
+            T& get()
+            {
+                return reinterpret_cast<T&>(value);
+            }
+        };
+
+    public:
+        using value_type = T;
+
+        static const bool multi_consumer = false;
+        static const bool numa_placement = false;
+
+    public:
+        /**
+         * @param capacity Maximum number of queued values. Zero means the queue is unbounded.
+         */
+        explicit mpsc_queue(std::size_t capacity = 0)
+            : capacity_(capacity)
+            , head_(new node())
+            , tail_(head_)
+        {
+        }
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+        ~mpsc_queue()
+        {
+            auto next = head_->next.load(std::memory_order_relaxed);
+            delete head_;
+
+            while (next)
+            {
+                auto current = next;
+                next = current->next.load(std::memory_order_relaxed);
+
+                current->get().~T();
+                delete current;
+            }
+        }
+
+        std::size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool push(U&& value)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Constructs a value in place at the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not constructed.
+         */
+        template <typename... Args>
+        bool emplace(Args&&... args)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue, if the queue is not full.
+         * @return false, if the queue is full or has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool try_push(U&& value)
+        {
+            return pushInternal(internal::no_wait(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits until the deadline for free space,
+         * if the queue is full.
+         * @return false, if the deadline expired or the queue has been closed and the value was not queued.
+         */
+        template <typename U, typename Clock, typename Duration>
+        bool push_until(U&& value, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return pushInternal(deadline, std::forward<U>(value));
+        }
+
+        /**
+         * @brief Waits for the next value and passes it as rvalue reference to the consumer.
+         *
+         * The value is consumed in place in its node, which is only freed after the consumer returned.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop(Consumer&& consumer)
+        {
+            auto next = head_->next.load(std::memory_order_acquire);
+
+            if (!next && !(next = waitNotEmpty(internal::no_deadline())))
+                return false;
+
+            try
+            {
+                consumer(std::move(next->get()));
+            }
+            catch (...)
+            {
+                popFront(next);
+                release(1);
+                throw;
+            }
+
+            popFront(next);
+            release(1);
+
+            return true;
+        }
+
+        /**
+         * @brief Waits for the next value and passes all queued values one after another as rvalue references
+         * to the consumer.
+         *
+         * Values that are pushed while the batch is consumed are left for the next call.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop_all(Consumer&& consumer)
+        {
+            return popAllInternal(consumer, internal::no_deadline());
+        }
+
+        /**
+         * @brief Waits until the deadline for the next value and passes all queued values one after another as
+         * rvalue references to the consumer.
+         * @return false, if the queue has been closed and all values have been consumed. true without consuming
+         * any value, if the deadline expired.
+         */
+        template <typename Consumer, typename Clock, typename Duration>
+        bool pop_all_until(Consumer&& consumer, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return popAllInternal(consumer, deadline);
+        }
+
+        /**
+         * @brief Rejects all further values and wakes up all waiting producers and the consumer.
+         *
+         * Values that were queued before are still passed to the consumer.
+         */
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                closed_.store(true, std::memory_order_release);
+            }
+
+            notEmpty_.notify_all();
+            notFull_.notify_all();
+        }
+
+    private:
+        template <typename Deadline, typename... Args>
+        bool pushInternal(const Deadline& deadline, Args&&... args)
+        {
+            if (closed_.load(std::memory_order_relaxed))
+                return false;
+
+            if (capacity_ != 0 && !acquire(deadline))
+                return false;
+
+            auto item = new node();
+
+            try
+            {
+                new (&item->value) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                delete item;
+                release(1);
+                throw;
+            }
+
+            const auto previous = tail_.exchange(item, std::memory_order_acq_rel);
+            previous->next.store(item, std::memory_order_release);
+
+            // The waiting consumer raises its flag before it checks the list again, the producer links its node
+            // before it checks the flag. The two fences guarantee that at least one of them sees the other's store.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (consumerWaiting_.load(std::memory_order_relaxed))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(guard_);
+                }
+
+                notEmpty_.notify_one();
+            }
+
+            return true;
+        }
+
+        template <typename Consumer, typename Deadline>
+        bool popAllInternal(Consumer& consumer, const Deadline& deadline)
+        {
+            auto next = head_->next.load(std::memory_order_acquire);
+
+            if (!next && !(next = waitNotEmpty(deadline)))
+            {
+                // Either the deadline expired or the queue has been closed. Values pushed before the queue was
+                // closed are left for the next call.
+                const auto closed = closed_.load(std::memory_order_acquire);
+                return !closed || head_->next.load(std::memory_order_acquire);
+            }
+
+            const auto last = tail_.load(std::memory_order_acquire);
+            auto count = std::size_t(0);
+
+            try
+            {
+                while (next)
+                {
+                    const auto isLast = next == last;
+
+                    ++count;
+
+                    try
+                    {
+                        consumer(std::move(next->get()));
+                    }
+                    catch (...)
+                    {
+                        popFront(next);
+                        throw;
+                    }
+
+                    popFront(next);
+
+                    next = isLast ? nullptr : head_->next.load(std::memory_order_acquire);
+                }
+            }
+            catch (...)
+            {
+                release(count);
+                throw;
+            }
+
+            release(count);
+
+            return true;
+        }
+
+        void popFront(node* next)
+        {
+            next->get().~T();
+
+            delete head_;
+            head_ = next;
+        }
+
+        template <typename Deadline>
+        node* waitNotEmpty(const Deadline& deadline)
+        {
+            auto next = static_cast<node*>(nullptr);
+
+            // A spinning consumer does not synchronize with close() by the mutex. It reads the flag first, so that
+            // it cannot miss values that were pushed before the queue was closed.
+            const auto ready = [&]
+            {
+                const auto closed = closed_.load(std::memory_order_acquire);
+                next = head_->next.load(std::memory_order_acquire);
+                return next || closed;
+            };
+
+            if (!WaitStrategy::spin([&] { return ready() || internal::expired(deadline); }))
+            {
+                std::unique_lock<std::mutex> lock(guard_);
+
+                consumerWaiting_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                internal::wait_until(notEmpty_, lock, deadline, ready);
+
+                consumerWaiting_.store(false, std::memory_order_relaxed);
+            }
+
+            return next;
+        }
+
+        // Reserves space for one value in a bounded queue.
+        template <typename Deadline>
+        bool acquire(const Deadline& deadline)
+        {
+            auto size = size_.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                if (size < capacity_)
+                {
+                    if (size_.compare_exchange_weak(size, size + 1, std::memory_order_relaxed))
+                        return true;
+
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(guard_);
+
+                waitingProducers_.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                const auto hasSpace = internal::wait_until(notFull_, lock, deadline, [&]
+                {
+                    size = size_.load(std::memory_order_relaxed);
+                    return size < capacity_ || closed_.load(std::memory_order_relaxed);
+                });
+
+                waitingProducers_.fetch_sub(1, std::memory_order_relaxed);
+
+                if (!hasSpace || closed_.load(std::memory_order_relaxed))
+                    return false;
+            }
+        }
+
+        // Frees the space of consumed values in a bounded queue.
+        void release(std::size_t count)
+        {
+            if (capacity_ == 0 || count == 0)
+                return;
+
+            size_.fetch_sub(count, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (waitingProducers_.load(std::memory_order_relaxed) != 0)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(guard_);
+                }
+
+                notFull_.notify_all();
+            }
+        }
+
+    private:
+        const std::size_t capacity_;
+
+        char padding0_[internal::cache_line_size];
+
+        // Written by the consumer
+        node* head_;
+
+        char padding1_[internal::cache_line_size];
+
+        // Written by the producers
+        std::atomic<node*> tail_;
+        std::atomic<std::size_t> size_ { 0 };
+
+        char padding2_[internal::cache_line_size];
+
+        std::atomic<bool> closed_ { false };
+        std::atomic<bool> consumerWaiting_ { false };
+        std::atomic<std::size_t> waitingProducers_ { 0 };
+
+        std::mutex guard_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+    };
+
+    template <typename T, typename WaitStrategy>
+    const bool mpsc_queue<T, WaitStrategy>::multi_consumer;
+
+    template <typename T, typename WaitStrategy>
+    const bool mpsc_queue<T, WaitStrategy>::numa_placement;
+
+    /**@}*/
+
+} // jstd
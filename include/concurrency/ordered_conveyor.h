@@ -0,0 +1,296 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "conveyor_options.h"
+#include "executor.h"
+#include "blocking_queue.h"
+#include "mpmc_queue.h"
+#include "internal/rebind_queue.h"
+#include "internal/sequenced_value.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Processes pushed values in parallel and passes the results to a sink in the order the values were
+     * pushed.
+     *
+     * Every value is tagged with a sequence number when it is pushed. The processor threads put their results into
+     * a bounded reorder buffer, from where they are passed on to the sink as soon as all results before them are
+     * done. The sink is never called concurrently, it runs on whichever processor thread completed the gap.
+     *
+     * @code
+     * auto&& compressor = jstd::ordered_conveyor<std::string, std::string>(
+     *         [](std::string&& chunk) { return compress(chunk); },
+     *         [&](std::string&& compressed) { file << compressed; },
+     *         options);
+     * @endcode
+     *
+     * If the processor or the sink throws, the conveyor stops: further values are rejected and pending results are
+     * dropped, because the order could not be kept anymore.
+     *
+     * @tparam ForwardType Type of the pushed values.
+     * @tparam ResultType Type of the processed values that are passed to the sink.
+     * @tparam Queue Type of the queue that transfers the values to the processor threads. More than one thread
+     * requires a queue that supports multiple consumers, like blocking_queue or mpmc_queue. Pushes are serialized
+     * by the conveyor, so the queue does not need to support multiple producers.
+     */
+    template <typename ForwardType, typename ResultType, typename Queue = blocking_queue<ForwardType> >
+    class ordered_conveyor
+    {
+        static_assert(std::is_move_constructible<ForwardType>::value,
+                      "The template parameter is not move constructable. "
+                      "If this type cannot be made move constructable use std::unique_ptr<T>.");
+
+        static_assert(std::is_move_constructible<ResultType>::value,
+                      "The result type is not move constructable. "
+                      "If this type cannot be made move constructable use std::unique_ptr<T>.");
+
+        using stored_type = internal::sequenced_value<ForwardType>;
+        using queue_type = typename internal::rebind_queue<Queue, stored_type>::type;
+
+        struct reorder_slot
+        {
+            bool filled = false;
+            typename std::aligned_storage<sizeof(ResultType), alignof(ResultType)>::type value;
+
+            ResultType& get()
+            {
+                return reinterpret_cast<ResultType&>(value);
+            }
+        };
+
+    public:
+        using ProcessorFunction = std::function<ResultType(ForwardType&&)>;
+        using SinkFunction = std::function<void(ResultType&&)>;
+
+    public:
+        ordered_conveyor(ProcessorFunction processor,
+                         SinkFunction sink,
+                         const conveyor_options& options = conveyor_options())
+            : processor_(std::move(processor))
+            , sink_(std::move(sink))
+            , queue_(options.capacity)
+            , reorderCapacity_(options.reorder_capacity != 0 ? options.reorder_capacity
+                                                             : 4 * std::max<std::size_t>(options.threads, 1))
+            , reorder_(new reorder_slot[reorderCapacity_])
+        {
+            start(options);
+        }
+
+        ordered_conveyor(const ordered_conveyor&) = delete;
+        ordered_conveyor& operator=(const ordered_conveyor&) = delete;
+
+        /**
+         * @brief Waits until all pushed values have been processed and passed to the sink.
+         */
+        ~ordered_conveyor()
+        {
+            queue_.close();
+
+            for (auto& processorHandle : processorHandles_)
+                processorHandle.wait();
+
+            for (auto i = std::size_t(0); i < reorderCapacity_; ++i)
+            {
+                if (reorder_[i].filled)
+                    reorder_[i].get().~ResultType();
+            }
+        }
+
+        /**
+         * @brief Pushes a value to the processors and waits for free space, if the queue is full.
+         *
+         * Pushes from several threads are serialized, their results reach the sink in the order the pushes
+         * took place.
+         */
+        void push(ForwardType&& forwardValue)
+        {
+            emplace(std::move(forwardValue));
+        }
+
+        template <typename T = ForwardType>
+        void push(const T& forwardValue,
+                  typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            emplace(forwardValue);
+        }
+
+        /**
+         * @brief Constructs a value in place in the queue and waits for free space, if the queue is full.
+         */
+        template <typename... Args>
+        void emplace(Args&&... args)
+        {
+            // The values have to enter the queue in the order of their sequence numbers. Otherwise the processor
+            // threads could wait for a result, whose value waits for free space in the queue.
+            std::lock_guard<std::mutex> lock(pushGuard_);
+
+            if (queue_.emplace(nextPushed_, std::forward<Args>(args)...))
+                ++nextPushed_;
+        }
+
+    private:
+        void start(const conveyor_options& options)
+        {
+            const auto threads = std::max<std::size_t>(options.threads, 1);
+
+            if (threads > 1 && !queue_type::multi_consumer)
+                throw std::invalid_argument("The queue of the conveyor does not support multiple processor threads.");
+
+            try
+            {
+                while (processorHandles_.size() < threads)
+                    processorHandles_.push_back(internal::launch(options, [this] { run(); }));
+            }
+            catch (...)
+            {
+                queue_.close();
+
+                for (auto& processorHandle : processorHandles_)
+                    processorHandle.wait();
+
+                throw;
+            }
+        }
+
+        void run()
+        {
+            try
+            {
+                while (queue_.pop([this](stored_type&& stored)
+                                  {
+                                      if (!stopped_.load(std::memory_order_relaxed))
+                                          deliver(stored.sequence, processor_(std::move(stored.value)));
+                                  }));
+            }
+            catch (...)
+            {
+                stop();
+                throw;
+            }
+        }
+
+        void deliver(std::size_t sequence, ResultType&& result)
+        {
+            std::unique_lock<std::mutex> lock(reorderGuard_);
+
+            const auto stopped = [this] { return stopped_.load(std::memory_order_relaxed); };
+
+            notFull_.wait(lock, [&] { return sequence < nextDelivered_ + reorderCapacity_ || stopped(); });
+
+            if (stopped())
+                return;
+
+            auto& slot = reorder_[sequence % reorderCapacity_];
+            new (&slot.value) ResultType(std::move(result));
+            slot.filled = true;
+
+            // Only one thread at a time passes results to the sink. The others leave their results in the buffer.
+            if (delivering_)
+                return;
+
+            delivering_ = true;
+
+            while (true)
+            {
+                auto& next = reorder_[nextDelivered_ % reorderCapacity_];
+
+                if (!next.filled || stopped())
+                    break;
+
+                auto value = std::move(next.get());
+                next.get().~ResultType();
+                next.filled = false;
+                ++nextDelivered_;
+
+                lock.unlock();
+                notFull_.notify_all();
+
+                try
+                {
+                    sink_(std::move(value));
+                }
+                catch (...)
+                {
+                    lock.lock();
+                    delivering_ = false;
+                    throw;
+                }
+
+                lock.lock();
+            }
+
+            delivering_ = false;
+        }
+
+        // A missing result would block all later results forever, so the conveyor stops completely.
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(reorderGuard_);
+                stopped_.store(true, std::memory_order_relaxed);
+            }
+
+            notFull_.notify_all();
+            queue_.close();
+        }
+
+    private:
+        ProcessorFunction processor_;
+        SinkFunction sink_;
+
+        queue_type queue_;
+        std::mutex pushGuard_;
+        std::size_t nextPushed_ { 0 };
+
+        const std::size_t reorderCapacity_;
+        const std::unique_ptr<reorder_slot[]> reorder_;
+        std::mutex reorderGuard_;
+        std::condition_variable notFull_;
+        std::size_t nextDelivered_ { 0 };
+        bool delivering_ { false };
+        std::atomic<bool> stopped_ { false };
+
+        std::vector<std::future<void> > processorHandles_;
+    };
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,205 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <exception>
+#include <memory>
+#include <type_traits>
+
+#include "conveyor_function.h"
+#include "conveyor_options.h"
+#include "executor.h"
+#include "internal/conveyor_assertions.h"
+#include "internal/conveyor_forwarder.h"
+#include "internal/pipeline_stage.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Chain of converters and a consumer like in conveyor_function, whose threads are started once and kept
+     * alive for many runs.
+     *
+     * conveyor_function starts and joins a thread per callable on every call. A pipeline pays this only on
+     * construction, so a run on a small input costs little more than forwarding its values.
+     *
+     * @code
+     * auto&& lines = jstd::make_pipeline(parse, jstd::parallel(4, transform), write);
+     *
+     * for (const auto& file : files)
+     *     lines->run([&](jstd::conveyor_forwarder<std::string>& forwarder) { read(file, forwarder); });
+     * @endcode
+     *
+     * An exception of a callable does not stop its stage. The first one is rethrown by the next run or flush,
+     * the values that were forwarded along with it are still processed.
+     *
+     * @tparam SourceType Type of the values that are pushed to the first callable.
+     */
+    template <typename SourceType>
+    class pipeline
+    {
+    public:
+        /**
+         * @param options Options of the stages like for conveyor_function, which bound their queues with a capacity.
+         * Threads of an executor are borrowed until the pipeline is closed.
+         * @param callables Converters and the consumer, with the same requirements as the callables of
+         * conveyor_function that follow the producer. A callable wrapped by parallel runs on multiple threads.
+         */
+        template <typename... Callables>
+        explicit pipeline(const conveyor_options& options, Callables&&... callables)
+            : state_(std::make_unique<internal::pipeline_state>())
+        {
+            internal::assert_stages<Callables...>();
+
+            const auto context = internal::pipeline_context { *state_, options };
+
+            auto&& stage = internal::make_stages<internal::pipeline_stage>(context,
+                                                                           std::forward<Callables>(callables)...);
+
+            forwarder_ = &stage->forwarder();
+            stage_ = std::move(stage);
+        }
+
+        pipeline(const pipeline&) = delete;
+        pipeline& operator=(const pipeline&) = delete;
+
+        /**
+         * @brief Closes the pipeline. Values that are still queued are processed before the threads stop.
+         */
+        ~pipeline()
+        {
+            close();
+        }
+
+        /**
+         * @brief Calls the producer on the calling thread and waits until all values it forwarded went through
+         * the pipeline.
+         *
+         * The producer has the signature @code void(static_forwarder<SourceType>&) @endcode
+         * or takes a conveyor_forwarder reference instead.
+         * Runs may overlap. A run then also waits for the values of the other runs.
+         * @throws Any exception of the producer or, if there is none, the first exception that a callable threw
+         * since the last run or flush. An exception of a callable is kept for the next run or flush, if the
+         * producer threw, because it may belong to another run or a push.
+         */
+        template <typename Producer>
+        void run(Producer&& producer)
+        {
+            try
+            {
+                producer(*forwarder_);
+            }
+            catch (...)
+            {
+                state_->wait();
+                throw;
+            }
+
+            flush();
+        }
+
+        /**
+         * @brief Pushes a single value to the first callable without waiting for it to be processed.
+         */
+        void push(SourceType&& value)
+        {
+            forwarder_->push(std::move(value));
+        }
+
+        /**
+         * @brief Waits until all pushed values went through the pipeline.
+         * @throws The first exception that a callable threw since the last run or flush.
+         */
+        void flush()
+        {
+            state_->wait();
+
+            if (auto error = state_->takeError())
+                std::rethrow_exception(error);
+        }
+
+        /**
+         * @brief Processes the values that are still queued and stops the threads of all stages.
+         * Values that are pushed afterwards are discarded.
+         */
+        void close()
+        {
+            if (stage_)
+                stage_->close();
+        }
+
+    private:
+        std::unique_ptr<internal::pipeline_state> state_;
+        std::unique_ptr<internal::pipeline_stage_proxy> stage_;
+        static_forwarder<SourceType>* forwarder_ = nullptr;
+    };
+
+    /**
+     * @brief Creates a pipeline, whose source type is deduced from the first callable.
+     */
+    template <typename Callable_0, typename... Callable_N,
+              typename SourceType = typename internal::callable_type<Callable_0>::source_type,
+              typename std::enable_if<!std::is_base_of<executor,
+                                                       typename std::decay<Callable_0>::type>::value &&
+                                      !std::is_same<conveyor_options,
+                                                    typename std::decay<Callable_0>::type>::value, int>::type = 0>
+    std::unique_ptr<pipeline<SourceType> > make_pipeline(Callable_0&& callable_0, Callable_N&&... callable_n)
+    {
+        return std::make_unique<pipeline<SourceType> >(conveyor_options(), std::forward<Callable_0>(callable_0),
+                                                       std::forward<Callable_N>(callable_n)...);
+    }
+
+    /**
+     * @brief Creates a pipeline, whose stages run on threads borrowed from the executor.
+     */
+    template <typename Callable_0, typename... Callable_N,
+              typename SourceType = typename internal::callable_type<Callable_0>::source_type>
+    std::unique_ptr<pipeline<SourceType> > make_pipeline(executor& executor,
+                                                         Callable_0&& callable_0, Callable_N&&... callable_n)
+    {
+        auto&& options = conveyor_options();
+        options.executor = &executor;
+
+        return std::make_unique<pipeline<SourceType> >(options, std::forward<Callable_0>(callable_0),
+                                                       std::forward<Callable_N>(callable_n)...);
+    }
+
+    /**
+     * @brief Creates a pipeline with the options applied to all stages, like a capacity for their queues.
+     */
+    template <typename Callable_0, typename... Callable_N,
+              typename SourceType = typename internal::callable_type<Callable_0>::source_type>
+    std::unique_ptr<pipeline<SourceType> > make_pipeline(const conveyor_options& options,
+                                                         Callable_0&& callable_0, Callable_N&&... callable_n)
+    {
+        return std::make_unique<pipeline<SourceType> >(options, std::forward<Callable_0>(callable_0),
+                                                       std::forward<Callable_N>(callable_n)...);
+    }
+
+    /**@}*/
+
+} // jstd
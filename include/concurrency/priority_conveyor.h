@@ -0,0 +1,535 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "conveyor_options.h"
+#include "executor.h"
+#include "internal/deadline.h"
+#include "internal/sequenced_value.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Storage of a priority_conveyor with a fixed number of FIFO lanes, one per priority.
+     *
+     * Pushing and taking a value are constant in time. Priority 0 is the highest, priorities must be lower
+     * than Lanes.
+     */
+    template <std::size_t Lanes>
+    struct priority_lanes
+    {
+        static_assert(Lanes > 0, "A priority_conveyor needs at least one lane.");
+
+        template <typename T>
+        class storage
+        {
+        public:
+            static void check(std::size_t priority)
+            {
+                if (priority >= Lanes)
+                    throw std::out_of_range("The priority exceeds the number of lanes of the priority_conveyor.");
+            }
+
+            bool empty() const
+            {
+                return size_ == 0;
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+            template <typename... Args>
+            void push(std::size_t priority, std::size_t sequence, Args&&... args)
+            {
+                lanes_[priority].emplace(sequence, std::forward<Args>(args)...);
+                ++size_;
+            }
+
+            internal::sequenced_value<T> take(bool oldest)
+            {
+                auto lane = std::size_t(0);
+
+                while (lanes_[lane].empty())
+                    ++lane;
+
+                // The front of each lane is its oldest value.
+                if (oldest)
+                {
+                    for (auto other = lane + 1; other < Lanes; ++other)
+                    {
+                        if (!lanes_[other].empty() && lanes_[other].front().sequence < lanes_[lane].front().sequence)
+                            lane = other;
+                    }
+                }
+
+                auto value = std::move(lanes_[lane].front());
+                lanes_[lane].pop();
+                --size_;
+
+                return value;
+            }
+
+        private:
+            std::array<std::queue<internal::sequenced_value<T> >, Lanes> lanes_;
+            std::size_t size_ { 0 };
+        };
+    };
+
+    /**
+     * @brief Storage of a priority_conveyor with a d-ary heap for arbitrary priorities.
+     *
+     * Pushing and taking a value are logarithmic in time, a wider heap is flatter and has fewer cache misses
+     * per operation. Priority 0 is the highest, values with the same priority are taken in push order.
+     * The values are also linked in push order, so taking the oldest value for the starvation guard is
+     * logarithmic as well. The stored type needs to be move assignable.
+     *
+     * @tparam Arity Number of children per node of the heap.
+     */
+    template <std::size_t Arity = 4>
+    struct priority_heap
+    {
+        static_assert(Arity > 1, "A heap needs at least two children per node.");
+
+        template <typename T>
+        class storage
+        {
+            static constexpr std::size_t none = std::size_t(-1);
+
+            // The entries keep their slot while they are stored, the heap only moves their slot numbers.
+            struct entry
+            {
+                template <typename... Args>
+                entry(std::size_t priority, std::size_t sequence, Args&&... args)
+                    : priority(priority)
+                    , value(sequence, std::forward<Args>(args)...)
+                {
+                }
+
+                std::size_t priority;
+                internal::sequenced_value<T> value;
+                std::size_t position { none };
+                std::size_t older { none };
+                std::size_t newer { none };
+            };
+
+        public:
+            static void check(std::size_t)
+            {
+            }
+
+            bool empty() const
+            {
+                return heap_.empty();
+            }
+
+            std::size_t size() const
+            {
+                return heap_.size();
+            }
+
+            template <typename... Args>
+            void push(std::size_t priority, std::size_t sequence, Args&&... args)
+            {
+                const auto slot = free_ != none ? free_ : entries_.size();
+
+                heap_.push_back(slot);
+
+                try
+                {
+                    if (slot == entries_.size())
+                        entries_.emplace_back(priority, sequence, std::forward<Args>(args)...);
+                    else
+                    {
+                        const auto nextFree = entries_[slot].newer;
+
+                        entries_[slot] = entry(priority, sequence, std::forward<Args>(args)...);
+                        free_ = nextFree;
+                    }
+                }
+                catch (...)
+                {
+                    heap_.pop_back();
+                    throw;
+                }
+
+                entries_[slot].older = newest_;
+
+                if (newest_ != none)
+                    entries_[newest_].newer = slot;
+                else
+                    oldest_ = slot;
+
+                newest_ = slot;
+
+                siftUp(heap_.size() - 1, slot);
+            }
+
+            internal::sequenced_value<T> take(bool oldest)
+            {
+                const auto slot = oldest ? oldest_ : heap_.front();
+                auto& taken = entries_[slot];
+
+                auto value = std::move(taken.value);
+
+                (taken.older != none ? entries_[taken.older].newer : oldest_) = taken.newer;
+                (taken.newer != none ? entries_[taken.newer].older : newest_) = taken.older;
+
+                const auto last = heap_.back();
+                heap_.pop_back();
+
+                if (taken.position != heap_.size())
+                    siftDown(siftUp(taken.position, last), last);
+
+                // The slot keeps the moved from value until it is reused by a push.
+                taken.newer = free_;
+                free_ = slot;
+
+                return value;
+            }
+
+        private:
+            bool before(std::size_t slot, std::size_t other) const
+            {
+                const auto& first = entries_[slot];
+                const auto& second = entries_[other];
+
+                return first.priority < second.priority
+                       || (first.priority == second.priority && first.value.sequence < second.value.sequence);
+            }
+
+            void place(std::size_t index, std::size_t slot)
+            {
+                heap_[index] = slot;
+                entries_[slot].position = index;
+            }
+
+            // Moves the slot up from the index and returns its final index.
+            std::size_t siftUp(std::size_t index, std::size_t slot)
+            {
+                while (index != 0)
+                {
+                    const auto parent = (index - 1) / Arity;
+
+                    if (!before(slot, heap_[parent]))
+                        break;
+
+                    place(index, heap_[parent]);
+                    index = parent;
+                }
+
+                place(index, slot);
+
+                return index;
+            }
+
+            void siftDown(std::size_t index, std::size_t slot)
+            {
+                while (true)
+                {
+                    const auto first = index * Arity + 1;
+
+                    if (first >= heap_.size())
+                        break;
+
+                    const auto last = std::min(first + Arity, heap_.size());
+                    auto best = first;
+
+                    for (auto child = first + 1; child < last; ++child)
+                    {
+                        if (before(heap_[child], heap_[best]))
+                            best = child;
+                    }
+
+                    if (!before(heap_[best], slot))
+                        break;
+
+                    place(index, heap_[best]);
+                    index = best;
+                }
+
+                place(index, slot);
+            }
+
+        private:
+            std::vector<entry> entries_;
+            std::vector<std::size_t> heap_;
+
+            // Ends of the list of stored entries in push order and the first free slot, free slots are linked
+            // by newer.
+            std::size_t oldest_ { none };
+            std::size_t newest_ { none };
+            std::size_t free_ { none };
+        };
+    };
+
+    /**
+     * @brief Passes pushed values to a processor function on separated threads, values of higher priority first.
+     *
+     * Values with the same priority are processed in the order they were pushed. Urgent values like control
+     * messages overtake bulk data, that has queued up, instead of waiting behind it. To keep bulk data from
+     * starving while urgent values keep arriving, see conveyor_options::starvation_limit.
+     *
+     * @code
+     * auto&& connection = jstd::priority_conveyor<message>([&](message&& value) { send(value); });
+     * connection.push(1, bulk);
+     * connection.push(0, heartbeat);
+     * @endcode
+     *
+     * @tparam ForwardType Type of the pushed values.
+     * @tparam Storage Either priority_lanes for a fixed number of priorities or priority_heap for arbitrary
+     * priorities. Priority 0 is the highest in both cases.
+     */
+    template <typename ForwardType, typename Storage = priority_lanes<4> >
+    class priority_conveyor
+    {
+        static_assert(std::is_move_constructible<ForwardType>::value,
+                      "The template parameter is not move constructable. "
+                      "If this type cannot be made move constructable use std::unique_ptr<T>.");
+
+        using storage_type = typename Storage::template storage<ForwardType>;
+
+    public:
+        using ProcessorFunction = std::function<void(ForwardType&&)>;
+
+    public:
+        /**
+         * @param options The capacity limits the number of pending values of all priorities together. Multiple
+         * threads process the values in parallel and no longer strictly by priority.
+         */
+        explicit priority_conveyor(ProcessorFunction processor, const conveyor_options& options = conveyor_options())
+            : processor_(std::move(processor))
+            , capacity_(options.capacity)
+            , starvationLimit_(options.starvation_limit)
+        {
+            try
+            {
+                do
+                    processorHandles_.push_back(internal::launch(options, [this] { run(); }));
+                while (processorHandles_.size() < options.threads);
+            }
+            catch (...)
+            {
+                close();
+
+                for (auto& processorHandle : processorHandles_)
+                    processorHandle.wait();
+
+                throw;
+            }
+        }
+
+        priority_conveyor(const priority_conveyor&) = delete;
+        priority_conveyor& operator=(const priority_conveyor&) = delete;
+
+        /**
+         * @brief Waits until all pushed values have been processed.
+         */
+        ~priority_conveyor()
+        {
+            close();
+
+            for (auto& processorHandle : processorHandles_)
+                processorHandle.wait();
+        }
+
+        /**
+         * @brief Pushes a value with the given priority and waits for free space, if the conveyor is full.
+         * @throw std::out_of_range, if the priority exceeds the lanes of the storage.
+         */
+        void push(std::size_t priority, ForwardType&& forwardValue)
+        {
+            pushInternal(priority, internal::no_deadline(), std::move(forwardValue));
+        }
+
+        template <typename T = ForwardType>
+        void push(std::size_t priority, const T& forwardValue,
+                  typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            pushInternal(priority, internal::no_deadline(), forwardValue);
+        }
+
+        /**
+         * @brief Constructs a value with the given priority in place and waits for free space, if the conveyor is
+         * full.
+         */
+        template <typename... Args>
+        void emplace(std::size_t priority, Args&&... args)
+        {
+            pushInternal(priority, internal::no_deadline(), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Pushes a value with the given priority, if the conveyor is not full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        bool try_push(std::size_t priority, ForwardType&& forwardValue)
+        {
+            return pushInternal(priority, internal::no_wait(), std::move(forwardValue));
+        }
+
+        template <typename T = ForwardType>
+        bool try_push(std::size_t priority, const T& forwardValue,
+                      typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return pushInternal(priority, internal::no_wait(), forwardValue);
+        }
+
+        /**
+         * @brief Pushes a value with the given priority and waits at most for the given duration for free space,
+         * if the conveyor is full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        template <typename Rep, typename Period>
+        bool push_for(std::size_t priority, ForwardType&& forwardValue,
+                      const std::chrono::duration<Rep, Period>& timeout)
+        {
+            return pushInternal(priority, std::chrono::steady_clock::now() + timeout, std::move(forwardValue));
+        }
+
+        template <typename Rep, typename Period, typename T = ForwardType>
+        bool push_for(std::size_t priority, const T& forwardValue, const std::chrono::duration<Rep, Period>& timeout,
+                      typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return pushInternal(priority, std::chrono::steady_clock::now() + timeout, forwardValue);
+        }
+
+    private:
+        bool isFull() const
+        {
+            return capacity_ != 0 && storage_.size() >= capacity_;
+        }
+
+        template <typename Deadline, typename... Args>
+        bool pushInternal(std::size_t priority, const Deadline& deadline, Args&&... args)
+        {
+            storage_type::check(priority);
+
+            std::unique_lock<std::mutex> lock(guard_);
+
+            if (isFull() && !closed_)
+            {
+                ++waitingProducers_;
+                internal::wait_until(notFull_, lock, deadline, [this] { return !isFull() || closed_; });
+                --waitingProducers_;
+            }
+
+            if (closed_ || isFull())
+                return false;
+
+            storage_.push(priority, nextSequence_++, std::forward<Args>(args)...);
+
+            lock.unlock();
+            notEmpty_.notify_one();
+
+            return true;
+        }
+
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                closed_ = true;
+            }
+
+            notEmpty_.notify_all();
+            notFull_.notify_all();
+        }
+
+        void run()
+        {
+            try
+            {
+                while (true)
+                {
+                    std::unique_lock<std::mutex> lock(guard_);
+
+                    notEmpty_.wait(lock, [this] { return !storage_.empty() || closed_; });
+
+                    if (storage_.empty())
+                        return;
+
+                    const auto oldest = starvationLimit_ != 0 && ++sinceOldest_ > starvationLimit_;
+
+                    if (oldest)
+                        sinceOldest_ = 0;
+
+                    auto value = storage_.take(oldest);
+
+                    const auto notifyProducer = waitingProducers_ != 0;
+
+                    lock.unlock();
+
+                    if (notifyProducer)
+                        notFull_.notify_one();
+
+                    processor_(std::move(value.value));
+                }
+            }
+            catch (...)
+            {
+                // Producers must not wait for a conveyor, that is not processed anymore.
+                close();
+                throw;
+            }
+        }
+
+    private:
+        ProcessorFunction processor_;
+
+        const std::size_t capacity_;
+        const std::size_t starvationLimit_;
+
+        storage_type storage_;
+        std::mutex guard_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+        std::size_t nextSequence_ { 0 };
+        std::size_t sinceOldest_ { 0 };
+        std::size_t waitingProducers_ { 0 };
+        bool closed_ { false };
+
+        std::vector<std::future<void> > processorHandles_;
+    };
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,99 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <utility>
+
+#include "mpmc_queue.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Lock-free free list of objects that are handed back from consumer to producer threads for reuse.
+     *
+     * Values like strings or vectors that are allocated by a producer and freed by the consumer on another thread
+     * cause cross-thread traffic in the allocator. If the consumer releases the spent values to a recycler and the
+     * producer acquires its values from it, the buffers of the values are reused and steady-state pushes do not
+     * allocate at all.
+     *
+     * @code
+     * auto&& buffers = jstd::recycler<std::string>(64);
+     *
+     * auto&& line = buffers.acquire();
+     * line.assign(text);
+     * ...
+     * buffers.release(std::move(line));
+     * @endcode
+     *
+     * @tparam T Type of the recycled objects. Acquire requires it to be default constructible.
+     */
+    template <typename T>
+    class recycler
+    {
+    public:
+        /**
+         * @param capacity Maximum number of objects that are kept for reuse.
+         */
+        explicit recycler(std::size_t capacity)
+            : free_(capacity)
+        {
+        }
+
+        recycler(const recycler&) = delete;
+        recycler& operator=(const recycler&) = delete;
+
+        /**
+         * @brief Returns a released object or a default constructed one, if no released object is left.
+         *
+         * The object keeps the state it was released with, so the caller is expected to overwrite it.
+         */
+        T acquire()
+        {
+            auto&& result = T();
+
+            free_.try_pop([&result](T&& value) { result = std::move(value); });
+
+            return std::move(result);
+        }
+
+        /**
+         * @brief Keeps an object for reuse. The object is destroyed, if the recycler is full.
+         */
+        void release(T&& value)
+        {
+            free_.try_push(std::move(value));
+        }
+
+    private:
+        mpmc_queue<T> free_;
+    };
+
+    /**@}*/
+
+} // jstd
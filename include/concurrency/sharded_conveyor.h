@@ -0,0 +1,213 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "conveyor.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Distributes pushed values by a key to a number of lanes, that are processed in parallel.
+     *
+     * Each lane is a conveyor with a single processor thread. All values with the same key end up in the same
+     * lane, so they are processed one after another in the order they were pushed. Values with different keys are
+     * processed in parallel, if their keys are hashed to different lanes.
+     *
+     * @code
+     * auto&& options = jstd::conveyor_options();
+     * options.threads = 8;
+     *
+     * auto&& events = jstd::sharded_conveyor<event, account_id>(
+     *         [](const event& value) { return value.account; },
+     *         [](event&& value) { apply(value); },
+     *         options);
+     * @endcode
+     *
+     * @tparam ForwardType Type of the pushed values.
+     * @tparam Key Type of the key that decides about the lane of a value.
+     * @tparam Queue Type of the queue of each lane. It needs to support multiple producers, if the conveyor is
+     * pushed to from more than one thread.
+     * @tparam Hash Hash function of the key.
+     */
+    template <typename ForwardType,
+              typename Key,
+              typename Queue = mpsc_queue<ForwardType>,
+              typename Hash = std::hash<Key> >
+    class sharded_conveyor
+    {
+    public:
+        using KeyFunction = std::function<Key(const ForwardType&)>;
+        using ProcessorFunction = std::function<void(ForwardType&&)>;
+
+    private:
+        // All lanes call the one processor of the sharded conveyor.
+        using lane_type = conveyor<ForwardType, Queue, std::reference_wrapper<ProcessorFunction> >;
+
+    public:
+        /**
+         * @param key Returns the key of a value.
+         * @param processor Called concurrently by all lanes.
+         * @param options The number of threads is the number of lanes. The capacity applies to each lane.
+         */
+        sharded_conveyor(KeyFunction key,
+                         ProcessorFunction processor,
+                         const conveyor_options& options = conveyor_options(),
+                         const Hash& hash = Hash())
+            : key_(std::move(key))
+            , processor_(std::move(processor))
+            , hash_(hash)
+        {
+            auto laneOptions = options;
+            laneOptions.threads = 1;
+
+            const auto lanes = options.threads == 0 ? 1 : options.threads;
+
+            lanes_.reserve(lanes);
+
+            while (lanes_.size() < lanes)
+                lanes_.push_back(std::make_unique<lane_type>(std::ref(processor_), laneOptions));
+        }
+
+        sharded_conveyor(const sharded_conveyor&) = delete;
+        sharded_conveyor& operator=(const sharded_conveyor&) = delete;
+
+        /**
+         * @brief Waits until all pushed values have been processed.
+         */
+        ~sharded_conveyor() = default;
+
+        /**
+         * @brief Pushes a value to the lane of its key and waits for free space, if the lane is full.
+         */
+        void push(ForwardType&& forwardValue)
+        {
+            laneOf(forwardValue).push(std::move(forwardValue));
+        }
+
+        template <typename T = ForwardType>
+        void push(const T& forwardValue,
+                  typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            laneOf(forwardValue).push(forwardValue);
+        }
+
+        /**
+         * @brief Pushes a value to the lane of its key, if the lane is not full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        bool try_push(ForwardType&& forwardValue)
+        {
+            return laneOf(forwardValue).try_push(std::move(forwardValue));
+        }
+
+        template <typename T = ForwardType>
+        bool try_push(const T& forwardValue,
+                      typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return laneOf(forwardValue).try_push(forwardValue);
+        }
+
+        /**
+         * @brief Pushes a value to the lane of its key and waits at most for the given duration for free space,
+         * if the lane is full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        template <typename Rep, typename Period>
+        bool push_for(ForwardType&& forwardValue, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            return laneOf(forwardValue).push_for(std::move(forwardValue), timeout);
+        }
+
+        template <typename Rep, typename Period, typename T = ForwardType>
+        bool push_for(const T& forwardValue, const std::chrono::duration<Rep, Period>& timeout,
+                      typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return laneOf(forwardValue).push_for(forwardValue, timeout);
+        }
+
+        /**
+         * @brief Pushes a value to the lane of its key and waits at most until the deadline for free space,
+         * if the lane is full.
+         * @return false, if the value was not pushed. An rvalue is left untouched in this case.
+         */
+        template <typename Clock, typename Duration>
+        bool push_until(ForwardType&& forwardValue, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return laneOf(forwardValue).push_until(std::move(forwardValue), deadline);
+        }
+
+        template <typename Clock, typename Duration, typename T = ForwardType>
+        bool push_until(const T& forwardValue, const std::chrono::time_point<Clock, Duration>& deadline,
+                        typename std::enable_if<std::is_copy_constructible<T>::value>::type* = 0 )
+        {
+            return laneOf(forwardValue).push_until(forwardValue, deadline);
+        }
+
+        /**
+         * @brief Number of lanes, that process values in parallel.
+         */
+        std::size_t lanes() const
+        {
+            return lanes_.size();
+        }
+
+        /**
+         * @brief Index of the lane that processes the values with the given key.
+         */
+        std::size_t lane(const Key& key) const
+        {
+            // Fibonacci hashing spreads hash functions like std::hash of integers, that return the key itself.
+            const auto mixed = static_cast<std::uint64_t>(hash_(key)) * UINT64_C(11400714819323198485);
+            return static_cast<std::size_t>((mixed >> 32) % lanes_.size());
+        }
+
+    private:
+        lane_type& laneOf(const ForwardType& forwardValue)
+        {
+            return *lanes_[lane(key_(forwardValue))];
+        }
+
+    private:
+        KeyFunction key_;
+        ProcessorFunction processor_;
+        Hash hash_;
+
+        // Declared last, so that the lanes are joined before the processor is destroyed.
+        std::vector<std::unique_ptr<lane_type> > lanes_;
+    };
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,405 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <new>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+#include "internal/affinity.h"
+#include "internal/cache_line.h"
+#include "internal/deadline.h"
+#include "wait_strategy.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Lock-free bounded ring buffer for exactly one producer and one consumer thread.
+     *
+     * Pushing and popping only touch the head and tail indices, which are kept on separate cache lines.
+     * The mutex and the condition variables are only used to park the consumer while the queue is empty or
+     * the producer while the queue is full.
+     *
+     * @tparam T Type of the queued values.
+     * @tparam WaitStrategy Decides how a consumer waits for the next value, e.g. park_wait, spin_wait or busy_wait.
+     * @warning Pushing from more than one thread or popping from more than one thread at a time is undefined.
+     */
+    template <typename T, typename WaitStrategy = park_wait>
+    class spsc_queue
+    {
+        using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    public:
+        using value_type = T;
+
+        static const bool multi_consumer = false;
+        static const bool numa_placement = true;
+
+        static const std::size_t default_capacity = 1024;
+
+    public:
+        /**
+         * @param capacity Maximum number of queued values. The capacity is rounded up to the next power of two.
+         * Zero selects the default capacity.
+         * @param node NUMA node the ring is allocated on, see conveyor_options::numa_node. A negative node allocates
+         * the ring from the heap.
+         */
+        explicit spsc_queue(std::size_t capacity = default_capacity, int node = -1)
+            : mask_(toMask(capacity == 0 ? default_capacity : capacity))
+            , ring_((mask_ + 1) * sizeof(storage_type), node)
+            , slots_(static_cast<storage_type*>(ring_.get()))
+        {
+        }
+
+        spsc_queue(const spsc_queue&) = delete;
+        spsc_queue& operator=(const spsc_queue&) = delete;
+
+        ~spsc_queue()
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+
+            for (auto head = head_.load(std::memory_order_relaxed); head != tail; ++head)
+                slot(head).~T();
+        }
+
+        std::size_t capacity() const
+        {
+            return mask_ + 1;
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool push(U&& value)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Constructs a value in place at the end of the queue and waits for free space, if the queue is full.
+         * @return false, if the queue has been closed and the value was not constructed.
+         */
+        template <typename... Args>
+        bool emplace(Args&&... args)
+        {
+            return pushInternal(internal::no_deadline(), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue, if the queue is not full.
+         * @return false, if the queue is full or has been closed and the value was not queued.
+         */
+        template <typename U>
+        bool try_push(U&& value)
+        {
+            return pushInternal(internal::no_wait(), std::forward<U>(value));
+        }
+
+        /**
+         * @brief Appends a value to the end of the queue and waits until the deadline for free space,
+         * if the queue is full.
+         * @return false, if the deadline expired or the queue has been closed and the value was not queued.
+         */
+        template <typename U, typename Clock, typename Duration>
+        bool push_until(U&& value, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return pushInternal(deadline, std::forward<U>(value));
+        }
+
+        /**
+         * @brief Waits for the next value and passes it as rvalue reference to the consumer.
+         *
+         * The value is consumed in place, its slot is only freed after the consumer returned.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop(Consumer&& consumer)
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+
+            if (head == cachedTail_)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+
+                if (head == cachedTail_ && !waitNotEmpty(head, internal::no_deadline()))
+                    return false;
+            }
+
+            try
+            {
+                consumer(std::move(slot(head)));
+            }
+            catch (...)
+            {
+                popFront(head);
+                notify(producerWaiting_, notFull_);
+                throw;
+            }
+
+            popFront(head);
+            notify(producerWaiting_, notFull_);
+
+            return true;
+        }
+
+        /**
+         * @brief Waits for the next value and passes all queued values one after another as rvalue references
+         * to the consumer.
+         *
+         * The producer is only notified about the free space once the whole batch has been consumed.
+         * @return false, if the queue has been closed and all values have been consumed.
+         */
+        template <typename Consumer>
+        bool pop_all(Consumer&& consumer)
+        {
+            return popAllInternal(consumer, internal::no_deadline());
+        }
+
+        /**
+         * @brief Waits until the deadline for the next value and passes all queued values one after another as
+         * rvalue references to the consumer.
+         * @return false, if the queue has been closed and all values have been consumed. true without consuming
+         * any value, if the deadline expired.
+         */
+        template <typename Consumer, typename Clock, typename Duration>
+        bool pop_all_until(Consumer&& consumer, const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            return popAllInternal(consumer, deadline);
+        }
+
+        /**
+         * @brief Rejects all further values and wakes up the waiting producer and consumer.
+         *
+         * Values that were queued before are still passed to the consumer.
+         */
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                closed_.store(true, std::memory_order_release);
+            }
+
+            notEmpty_.notify_all();
+            notFull_.notify_all();
+        }
+
+    private:
+        static std::size_t toMask(std::size_t capacity)
+        {
+            return internal::round_up_to_power_of_two(capacity < 2 ? 2 : capacity) - 1;
+        }
+
+        template <typename Consumer, typename Deadline>
+        bool popAllInternal(Consumer& consumer, const Deadline& deadline)
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+
+            if (head == cachedTail_)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+
+                if (head == cachedTail_ && !waitNotEmpty(head, deadline))
+                {
+                    // Either the deadline expired or the queue has been closed. Values pushed before the queue was
+                    // closed are left for the next call.
+                    const auto closed = closed_.load(std::memory_order_acquire);
+                    return !closed || tail_.load(std::memory_order_acquire) != head;
+                }
+            }
+
+            try
+            {
+                for (; head != cachedTail_; ++head)
+                {
+                    try
+                    {
+                        consumer(std::move(slot(head)));
+                    }
+                    catch (...)
+                    {
+                        popFront(head);
+                        throw;
+                    }
+
+                    popFront(head);
+                }
+            }
+            catch (...)
+            {
+                notify(producerWaiting_, notFull_);
+                throw;
+            }
+
+            notify(producerWaiting_, notFull_);
+
+            return true;
+        }
+
+        template <typename Deadline, typename... Args>
+        bool pushInternal(const Deadline& deadline, Args&&... args)
+        {
+            if (closed_.load(std::memory_order_relaxed))
+                return false;
+
+            const auto tail = tail_.load(std::memory_order_relaxed);
+
+            if (tail - cachedHead_ > mask_)
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+
+                if (tail - cachedHead_ > mask_ && !waitNotFull(tail, deadline))
+                    return false;
+            }
+
+            new (&slots_[tail & mask_]) T(std::forward<Args>(args)...);
+            tail_.store(tail + 1, std::memory_order_release);
+
+            notify(consumerWaiting_, notEmpty_);
+
+            return true;
+        }
+
+        T& slot(std::size_t index)
+        {
+            return reinterpret_cast<T&>(slots_[index & mask_]);
+        }
+
+        // Destroys the value at the head after it has been consumed and passes its slot back to the producer.
+        void popFront(std::size_t head)
+        {
+            slot(head).~T();
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+        // The waiting side raises its flag before it checks the indices again, the other side publishes its index
+        // before it checks the flag. The two fences guarantee that at least one of them sees the other's store.
+
+        void notify(std::atomic<bool>& waiting, std::condition_variable& cv)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (waiting.load(std::memory_order_relaxed))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(guard_);
+                }
+
+                cv.notify_one();
+            }
+        }
+
+        template <typename Deadline>
+        bool waitNotEmpty(std::size_t head, const Deadline& deadline)
+        {
+            // A spinning consumer does not synchronize with close() by the mutex. It reads the flag first, so that
+            // it cannot miss values that were pushed before the queue was closed.
+            const auto ready = [&]
+            {
+                const auto closed = closed_.load(std::memory_order_acquire);
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                return cachedTail_ != head || closed;
+            };
+
+            if (!WaitStrategy::spin([&] { return ready() || internal::expired(deadline); }))
+            {
+                std::unique_lock<std::mutex> lock(guard_);
+
+                consumerWaiting_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                internal::wait_until(notEmpty_, lock, deadline, ready);
+
+                consumerWaiting_.store(false, std::memory_order_relaxed);
+            }
+
+            return cachedTail_ != head;
+        }
+
+        template <typename Deadline>
+        bool waitNotFull(std::size_t tail, const Deadline& deadline)
+        {
+            std::unique_lock<std::mutex> lock(guard_);
+
+            producerWaiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            internal::wait_until(notFull_, lock, deadline, [&]
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                return tail - cachedHead_ <= mask_ || closed_.load(std::memory_order_relaxed);
+            });
+
+            producerWaiting_.store(false, std::memory_order_relaxed);
+
+            return tail - cachedHead_ <= mask_ && !closed_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        const std::size_t mask_;
+        const internal::node_memory ring_;
+        storage_type* const slots_;
+
+        char padding0_[internal::cache_line_size];
+
+        // Written by the consumer
+        std::atomic<std::size_t> head_ { 0 };
+        std::size_t cachedTail_ { 0 };
+
+        char padding1_[internal::cache_line_size];
+
+        // Written by the producer
+        std::atomic<std::size_t> tail_ { 0 };
+        std::size_t cachedHead_ { 0 };
+
+        char padding2_[internal::cache_line_size];
+
+        std::atomic<bool> closed_ { false };
+        std::atomic<bool> consumerWaiting_ { false };
+        std::atomic<bool> producerWaiting_ { false };
+
+        std::mutex guard_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+    };
+
+    template <typename T, typename WaitStrategy>
+    const bool spsc_queue<T, WaitStrategy>::multi_consumer;
+
+    template <typename T, typename WaitStrategy>
+    const bool spsc_queue<T, WaitStrategy>::numa_placement;
+
+    template <typename T, typename WaitStrategy>
+    const std::size_t spsc_queue<T, WaitStrategy>::default_capacity;
+
+    /**@}*/
+
+} // jstd
@@ -0,0 +1,149 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "executor.h"
+
+namespace jstd
+{
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Executor that keeps its threads alive and reuses them for later tasks.
+     *
+     * A task is handed to an idle thread of the pool. Only if all threads are busy, a new thread is started,
+     * so tasks never wait for each other. A conveyor that runs on the pool borrows a thread for its lifetime and
+     * returns it on destruction, which makes creating short-lived conveyors cheap.
+     *
+     * @warning The pool must outlive all conveyors that run on it. Tasks must not throw.
+     */
+    class thread_pool : public executor
+    {
+    public:
+        /**
+         * @param threads Number of threads that are started in advance.
+         */
+        explicit thread_pool(std::size_t threads = 0)
+        {
+            std::lock_guard<std::mutex> lock(guard_);
+
+            while (threads_.size() < threads)
+                startThread();
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        /**
+         * @brief Waits for all tasks to finish and stops the threads.
+         */
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                shouldFinish_ = true;
+            }
+
+            cv_.notify_all();
+
+            for (auto& thread : threads_)
+                thread.join();
+        }
+
+        void execute(std::function<void()>&& task) override
+        {
+            std::unique_lock<std::mutex> lock(guard_);
+
+            tasks_.push(std::move(task));
+
+            if (tasks_.size() > idleThreads_)
+                startThread();
+
+            lock.unlock();
+            cv_.notify_one();
+        }
+
+        /**
+         * @brief Number of threads that have been started by the pool.
+         */
+        std::size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(guard_);
+            return threads_.size();
+        }
+
+    private:
+        // Called with guard_ locked. A new thread counts as idle until it has taken a task.
+        void startThread()
+        {
+            threads_.emplace_back([this] { work(); });
+            ++idleThreads_;
+        }
+
+        void work()
+        {
+            std::unique_lock<std::mutex> lock(guard_);
+
+            while (true)
+            {
+                cv_.wait(lock, [this] { return !tasks_.empty() || shouldFinish_; });
+
+                if (tasks_.empty())
+                    return;
+
+                auto task = std::move(tasks_.front());
+                tasks_.pop();
+                --idleThreads_;
+
+                lock.unlock();
+                task();
+                lock.lock();
+
+                ++idleThreads_;
+            }
+        }
+
+    private:
+        mutable std::mutex guard_;
+        std::condition_variable cv_;
+
+        std::queue<std::function<void()> > tasks_;
+        std::vector<std::thread> threads_;
+
+        std::size_t idleThreads_ { 0 };
+        bool shouldFinish_ { false };
+    };
+
+    /**@}*/
+
+} // jstd
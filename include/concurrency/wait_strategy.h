@@ -0,0 +1,128 @@
+#pragma once
+
+// MIT License
+//
+// Copyright (c) 2017 Jan Schwers
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstddef>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+namespace jstd
+{
+    namespace internal
+    {
+        // Tells the core that the thread is spinning, which saves power and frees resources for a sibling
+        // hyper-thread.
+        inline void cpu_relax()
+        {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+            _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+
+    } // internal
+
+    /**
+     * @addtogroup concurrency
+     * @{
+     */
+
+    /**
+     * @brief Wait strategy that parks a waiting consumer right away.
+     *
+     * A wait strategy is a type with a static function spin(ready), that waits until ready() returns true or gives
+     * up by returning false. A lock-free queue calls it before it parks its consumer on the condition variable.
+     *
+     * This is the default of all lock-free queues. It costs no CPU time while the queue is empty, but the next
+     * push has to wake the consumer up again.
+     */
+    struct park_wait
+    {
+        template <typename Predicate>
+        static bool spin(Predicate&&)
+        {
+            return false;
+        }
+    };
+
+    /**
+     * @brief Wait strategy that spins and yields for a bounded time before it parks a waiting consumer.
+     *
+     * Values that arrive while the consumer spins are taken without a wake up, which cuts the latency of a
+     * conveyor that is fed in short bursts.
+     *
+     * @tparam SpinCount Number of checks with a pause instruction in between.
+     * @tparam YieldCount Number of checks after the spinning, that give up the time slice in between.
+     */
+    template <std::size_t SpinCount = 4096, std::size_t YieldCount = 64>
+    struct spin_wait
+    {
+        template <typename Predicate>
+        static bool spin(Predicate&& ready)
+        {
+            for (auto i = std::size_t(0); i < SpinCount; ++i)
+            {
+                if (ready())
+                    return true;
+
+                internal::cpu_relax();
+            }
+
+            for (auto i = std::size_t(0); i < YieldCount; ++i)
+            {
+                if (ready())
+                    return true;
+
+                std::this_thread::yield();
+            }
+
+            return ready();
+        }
+    };
+
+    /**
+     * @brief Wait strategy that never parks a waiting consumer and polls the queue instead.
+     *
+     * @warning The consumer keeps its core busy while the queue is empty. Only use it with a core of its own.
+     */
+    struct busy_wait
+    {
+        template <typename Predicate>
+        static bool spin(Predicate&& ready)
+        {
+            while (!ready())
+                internal::cpu_relax();
+
+            return true;
+        }
+    };
+
+    /**@}*/
+
+} // jstd